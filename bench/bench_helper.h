@@ -0,0 +1,39 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/types.h"
+#include <chrono>
+#include <cstdio>
+
+namespace ha::fx_collection::bench {
+
+//-----------------------------------------------------------------------------
+/**
+ * @brief Runs func once and returns the elapsed wall clock time in [seconds].
+ */
+template <typename Func>
+f64 measure_seconds(Func&& func)
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto const start = Clock::now();
+    func();
+    std::chrono::duration<double> const elapsed = Clock::now() - start;
+
+    return elapsed.count();
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * @brief Prints the measured time and how many times faster than realtime
+ * the processing ran.
+ */
+inline void print_result(char const* name, f64 seconds, f64 audio_seconds)
+{
+    std::printf("%-40s %10.3f ms %10.1fx realtime\n", name, seconds * 1000.,
+                audio_seconds / seconds);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace ha::fx_collection::bench
@@ -0,0 +1,96 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "bench_helper.h"
+#include "ha/fx_collection/cpu_dispatch.h"
+#include "ha/fx_collection/trance_gate.h"
+#include <string>
+#include <vector>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+constexpr f32 SAMPLE_RATE = f32(44100.);
+constexpr i32 BLOCK_SIZE  = 256;
+constexpr i32 NUM_BLOCKS  = i32(SAMPLE_RATE) * 60 / BLOCK_SIZE;
+
+//-----------------------------------------------------------------------------
+TranceGate create_trance_gate(bool is_sample_accurate)
+{
+    auto trance_gate = TranceGateImpl::create();
+    TranceGateImpl::set_sample_rate(trance_gate, SAMPLE_RATE);
+    TranceGateImpl::set_step_len(trance_gate, f32(1. / 16.));
+    TranceGateImpl::set_stereo_mode(trance_gate, true);
+    TranceGateImpl::set_width(trance_gate, f32(0.3));
+    TranceGateImpl::set_shuffle_amount(trance_gate, f32(0.5));
+    TranceGateImpl::set_mix(trance_gate, f32(0.8));
+    TranceGateImpl::set_sample_accurate(trance_gate, is_sample_accurate);
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        f32 value = i % 3 ? f32(1.) : f32(0.25);
+        TranceGateImpl::set_step(trance_gate, TranceGate::L, i, value);
+        TranceGateImpl::set_step(trance_gate, TranceGate::R, i, f32(1.) - value);
+    }
+
+    return trance_gate;
+}
+
+//-----------------------------------------------------------------------------
+template <typename Func>
+void run(std::string const& name, bool is_sample_accurate, Func&& process)
+{
+    auto trance_gate = create_trance_gate(is_sample_accurate);
+
+    std::vector<AudioFrame> in(BLOCK_SIZE, AudioFrame{f32(0.5), f32(-0.5)});
+    std::vector<AudioFrame> out(BLOCK_SIZE, zero_audio_frame);
+
+    f64 const seconds = bench::measure_seconds([&]() {
+        for (mut_i32 i = 0; i < NUM_BLOCKS; ++i)
+            process(trance_gate, in.data(), out.data());
+    });
+
+    f64 const audio_seconds = f64(NUM_BLOCKS) * BLOCK_SIZE / SAMPLE_RATE;
+    bench::print_result(name.c_str(), seconds, audio_seconds);
+}
+
+//-----------------------------------------------------------------------------
+void run_timing(char const* timing, bool is_sample_accurate)
+{
+    constexpr char const* ISA_NAMES[] = {"scalar", "sse2", "avx2", "avx512"};
+    constexpr Isa ISAS[] = {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512};
+
+    run(std::string("process, ") + timing, is_sample_accurate,
+        [](TranceGate& trance_gate, AudioFrame const* in, AudioFrame* out) {
+            for (mut_i32 i = 0; i < BLOCK_SIZE; ++i)
+                TranceGateImpl::process(trance_gate, in[i], out[i]);
+        });
+
+    Isa const detected = detect_isa();
+    for (mut_i32 i = 0; i < 4; ++i)
+    {
+        if (!force_isa(ISAS[i]))
+            continue;
+
+        run(std::string("process_block ") + ISA_NAMES[i] + ", " + timing,
+            is_sample_accurate,
+            [](TranceGate& trance_gate, AudioFrame const* in, AudioFrame* out) {
+                TranceGateImpl::process_block(trance_gate, in, out,
+                                              BLOCK_SIZE);
+            });
+    }
+
+    force_isa(detected);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+int main()
+{
+    run_timing("float phase", false);
+    run_timing("sample accurate", true);
+
+    return 0;
+}
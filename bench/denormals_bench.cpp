@@ -0,0 +1,71 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "bench_helper.h"
+#include "ha/fx_collection/trance_gate.h"
+#include <vector>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+constexpr f32 SAMPLE_RATE = f32(44100.);
+constexpr i32 BLOCK_SIZE  = 256;
+constexpr i32 NUM_BLOCKS  = i32(SAMPLE_RATE) * 10 / BLOCK_SIZE;
+
+//-----------------------------------------------------------------------------
+/*  A closed gate with a short contour: the filters decay from 1.0 into the
+    subnormal range within a few thousand samples and stay there, because
+    the smallest subnormal times the pole rounds back to itself.
+ */
+TranceGate create_closed_gate(bool is_denormal_safe)
+{
+    auto trance_gate = TranceGateImpl::create();
+    TranceGateImpl::set_sample_rate(trance_gate, SAMPLE_RATE);
+    TranceGateImpl::set_contour(trance_gate, f32(0.001));
+    TranceGateImpl::set_denormal_safe(trance_gate, is_denormal_safe);
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        TranceGateImpl::set_step(trance_gate, TranceGate::L, i, f32(0.));
+        TranceGateImpl::set_step(trance_gate, TranceGate::R, i, f32(0.));
+    }
+    for (auto& filter : trance_gate.contour_filters)
+        ha::dtb::filtering::OnePoleImpl::reset(filter, f32(1.));
+
+    return trance_gate;
+}
+
+//-----------------------------------------------------------------------------
+void run(char const* name, bool is_denormal_safe)
+{
+    auto trance_gate = create_closed_gate(is_denormal_safe);
+
+    std::vector<AudioFrame> in(BLOCK_SIZE, AudioFrame{f32(1e-3), f32(1e-3)});
+    std::vector<AudioFrame> out(BLOCK_SIZE, zero_audio_frame);
+
+    // Warm up until the filter states are subnormal.
+    for (mut_i32 i = 0; i < NUM_BLOCKS / 10; ++i)
+        TranceGateImpl::process_block(trance_gate, in.data(), out.data(),
+                                      BLOCK_SIZE);
+
+    f64 const seconds = bench::measure_seconds([&]() {
+        for (mut_i32 i = 0; i < NUM_BLOCKS; ++i)
+            TranceGateImpl::process_block(trance_gate, in.data(), out.data(),
+                                          BLOCK_SIZE);
+    });
+
+    f64 const audio_seconds = f64(NUM_BLOCKS) * BLOCK_SIZE / SAMPLE_RATE;
+    bench::print_result(name, seconds, audio_seconds);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+int main()
+{
+    run("trance_gate (subnormal filter states)", false);
+    run("trance_gate (denormal safe)", true);
+
+    return 0;
+}
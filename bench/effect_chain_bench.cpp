@@ -0,0 +1,153 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "bench_helper.h"
+#include "ha/fx_collection/effect_chain.h"
+#include "ha/fx_collection/gain_pan.h"
+#include "ha/fx_collection/trance_gate.h"
+#include <vector>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+using ChainImpl = EffectChainImpl<Effect<TranceGate, TranceGateImpl>,
+                                  Effect<GainPan, GainPanImpl>>;
+using GainChainImpl =
+    EffectChainImpl<Effect<GainPan, GainPanImpl>, Effect<GainPan, GainPanImpl>>;
+
+constexpr f32 SAMPLE_RATE = f32(44100.);
+// 16 MB per buffer, way larger than the caches.
+constexpr i32 NUM_FRAMES  = 1 << 20;
+constexpr i32 NUM_REPEATS = 8;
+constexpr f64 BUFFER_MB   = f64(NUM_FRAMES) * sizeof(AudioFrame) / (1 << 20);
+
+//-----------------------------------------------------------------------------
+void print_traffic(i32 num_buffer_passes)
+{
+    std::printf("%-40s %10.1f MB\n", "  buffer traffic per repeat",
+                num_buffer_passes * BUFFER_MB);
+}
+
+//-----------------------------------------------------------------------------
+void setup_trance_gate(TranceGate& trance_gate)
+{
+    TranceGateImpl::set_sample_rate(trance_gate, SAMPLE_RATE);
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        f32 value = i % 2 ? f32(0.) : f32(1.);
+        TranceGateImpl::set_step(trance_gate, TranceGate::L, i, value);
+        TranceGateImpl::set_step(trance_gate, TranceGate::R, i, value);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/*  Both variants process the trance gate frame by frame, so only the buffer
+    traffic differs. TranceGateImpl::process_block would add its SIMD kernels
+    on top, see cpu_dispatch_bench.
+ */
+void run_separate_passes(std::vector<AudioFrame> const& in,
+                         std::vector<AudioFrame>& tmp,
+                         std::vector<AudioFrame>& out)
+{
+    auto trance_gate = TranceGateImpl::create();
+    setup_trance_gate(trance_gate);
+    auto gain_pan = GainPanImpl::create();
+    GainPanImpl::set_pan(gain_pan, f32(0.25));
+
+    f64 const seconds = bench::measure_seconds([&]() {
+        for (mut_i32 r = 0; r < NUM_REPEATS; ++r)
+        {
+            for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+                TranceGateImpl::process(trance_gate, in[i], tmp[i]);
+            for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+                GainPanImpl::process(gain_pan, tmp[i], out[i]);
+        }
+    });
+
+    bench::print_result("trance_gate + gain_pan (2 passes)", seconds,
+                        f64(NUM_FRAMES) * NUM_REPEATS / SAMPLE_RATE);
+    print_traffic(4);
+}
+
+//-----------------------------------------------------------------------------
+void run_fused_chain(std::vector<AudioFrame> const& in,
+                     std::vector<AudioFrame>& out)
+{
+    auto chain = ChainImpl::create();
+    setup_trance_gate(ChainImpl::get<0>(chain));
+    GainPanImpl::set_pan(ChainImpl::get<1>(chain), f32(0.25));
+
+    f64 const seconds = bench::measure_seconds([&]() {
+        for (mut_i32 r = 0; r < NUM_REPEATS; ++r)
+            ChainImpl::process_block(chain, in.data(), out.data(), NUM_FRAMES);
+    });
+
+    bench::print_result("trance_gate + gain_pan (fused chain)", seconds,
+                        f64(NUM_FRAMES) * NUM_REPEATS / SAMPLE_RATE);
+    print_traffic(2);
+}
+
+//-----------------------------------------------------------------------------
+/*  Two cheap effects are bound by memory bandwidth, not by computation. Here
+    the saved buffer pass shows up directly in the timing.
+ */
+void run_gain_passes(std::vector<AudioFrame> const& in,
+                     std::vector<AudioFrame>& tmp,
+                     std::vector<AudioFrame>& out)
+{
+    auto gain_pan_a = GainPanImpl::create();
+    auto gain_pan_b = GainPanImpl::create();
+    GainPanImpl::set_pan(gain_pan_b, f32(0.25));
+
+    f64 const seconds = bench::measure_seconds([&]() {
+        for (mut_i32 r = 0; r < NUM_REPEATS; ++r)
+        {
+            for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+                GainPanImpl::process(gain_pan_a, in[i], tmp[i]);
+            for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+                GainPanImpl::process(gain_pan_b, tmp[i], out[i]);
+        }
+    });
+
+    bench::print_result("gain_pan + gain_pan (2 passes)", seconds,
+                        f64(NUM_FRAMES) * NUM_REPEATS / SAMPLE_RATE);
+    print_traffic(4);
+}
+
+//-----------------------------------------------------------------------------
+void run_gain_chain(std::vector<AudioFrame> const& in,
+                    std::vector<AudioFrame>& out)
+{
+    auto chain = GainChainImpl::create();
+    GainPanImpl::set_pan(GainChainImpl::get<1>(chain), f32(0.25));
+
+    f64 const seconds = bench::measure_seconds([&]() {
+        for (mut_i32 r = 0; r < NUM_REPEATS; ++r)
+            GainChainImpl::process_block(chain, in.data(), out.data(),
+                                         NUM_FRAMES);
+    });
+
+    bench::print_result("gain_pan + gain_pan (fused chain)", seconds,
+                        f64(NUM_FRAMES) * NUM_REPEATS / SAMPLE_RATE);
+    print_traffic(2);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+int main()
+{
+    std::vector<AudioFrame> in(NUM_FRAMES,
+                               AudioFrame{f32(0.5), f32(0.5), f32(0.), f32(0.)});
+    std::vector<AudioFrame> tmp(NUM_FRAMES, zero_audio_frame);
+    std::vector<AudioFrame> out(NUM_FRAMES, zero_audio_frame);
+
+    run_separate_passes(in, tmp, out);
+    run_fused_chain(in, out);
+    run_gain_passes(in, tmp, out);
+    run_gain_chain(in, out);
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "bench_helper.h"
+#include "ha/fx_collection/compact_trance_gate.h"
+#include "ha/fx_collection/trance_gate.h"
+#include <vector>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+constexpr f32 SAMPLE_RATE   = f32(44100.);
+constexpr i32 BLOCK_SIZE    = 64;
+constexpr i32 NUM_INSTANCES = 4096;
+constexpr i32 NUM_BLOCKS    = 64;
+
+//-----------------------------------------------------------------------------
+/*  Processes one block per instance, round robin, like a host running many
+    voices. With thousands of instances the contexts do not fit into L2, so
+    the footprint directly shows up in the number of instances per core. All
+    gates are processed frame by frame, so only the context size differs.
+ */
+template <typename Impl, typename Gate>
+void run(char const* name)
+{
+    constexpr std::size_t footprint = Impl::footprint();
+
+    std::vector<Gate> gates(NUM_INSTANCES, Impl::create());
+    for (auto& gate : gates)
+    {
+        Impl::set_sample_rate(gate, SAMPLE_RATE);
+        for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+        {
+            f32 value = i % 2 ? f32(0.) : f32(1.);
+            Impl::set_step(gate, TranceGate::L, i, value);
+            Impl::set_step(gate, TranceGate::R, i, value);
+        }
+    }
+
+    std::vector<AudioFrame> in(BLOCK_SIZE, AudioFrame{f32(0.5), f32(0.5)});
+    std::vector<AudioFrame> out(BLOCK_SIZE, zero_audio_frame);
+
+    f64 const seconds = bench::measure_seconds([&]() {
+        for (mut_i32 b = 0; b < NUM_BLOCKS; ++b)
+            for (auto& gate : gates)
+                for (mut_i32 i = 0; i < BLOCK_SIZE; ++i)
+                    Impl::process(gate, in[i], out[i]);
+    });
+
+    f64 const audio_seconds = f64(NUM_BLOCKS) * BLOCK_SIZE / SAMPLE_RATE;
+    f64 const instances_per_core = NUM_INSTANCES * audio_seconds / seconds;
+    std::printf("%-24s %6zu bytes %8.1f KB total %10.0f instances/core\n",
+                name, footprint, f64(footprint) * NUM_INSTANCES / 1024.,
+                instances_per_core);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+int main()
+{
+    run<TranceGateImpl, TranceGate>("trance_gate");
+    run<QuantizedTranceGateImpl, QuantizedTranceGate>("quantized_trance_gate");
+    run<BinaryTranceGateImpl, BinaryTranceGate>("binary_trance_gate");
+
+    return 0;
+}
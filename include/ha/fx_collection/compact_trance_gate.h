@@ -0,0 +1,223 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/sample_timeline.h"
+#include "ha/fx_collection/trance_gate.h"
+#include "ha/fx_collection/types.h"
+#include <array>
+#include <cstddef>
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+/**
+ * compact_trance_gate
+ *
+ * Trance gate with a small memory footprint for running many instances. The
+ * step values are quantized to 8 bits (QuantizedSteps) or bit-packed on/off
+ * (BinarySteps). Delay, fade in and steps share one SampleTimeline, which
+ * counts the samples since the last trigger. The steps therefore follow the
+ * trigger only, there is no resync to the project time.
+ */
+
+struct QuantizedSteps
+{
+    static constexpr u32 MAX_VALUE = 255;
+
+    using StepValues = std::array<mut_u8, TranceGate::MAX_NUM_STEPS>;
+    std::array<StepValues, TranceGate::NUM_CHANNELS> values{};
+};
+
+struct BinarySteps
+{
+    static_assert(TranceGate::MAX_NUM_STEPS <= 32, "One bit per step in u32");
+
+    std::array<mut_u32, TranceGate::NUM_CHANNELS> bits{};
+};
+
+struct StepStorageImpl final
+{
+    /**
+     * @brief Returns the amount [normalised] of a step.
+     */
+    static f32 get(QuantizedSteps const& steps, i32 channel, i32 step)
+    {
+        constexpr f32 MAX_VALUE = f32(QuantizedSteps::MAX_VALUE);
+        return f32(steps.values[channel][step]) / MAX_VALUE;
+    }
+
+    static f32 get(BinarySteps const& steps, i32 channel, i32 step)
+    {
+        return (steps.bits[channel] >> step) & 1 ? f32(1.) : f32(0.);
+    }
+
+    /**
+     * @brief Sets the amount [normalised] of a step. Binary steps are on for
+     * values of 0.5 and above. Throws std::out_of_range for invalid channels
+     * or steps.
+     */
+    static void
+    set(QuantizedSteps& steps, i32 channel, i32 step, f32 value_normalised);
+    static void
+    set(BinarySteps& steps, i32 channel, i32 step, f32 value_normalised);
+};
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+struct CompactTranceGate
+{
+    StepStorage steps;
+    TranceGate::ContourFilters contour_filters;
+
+    // The sample position is the time since trigger.
+    SampleTimeline timeline;
+    mut_u32 delay_len   = 0;
+    mut_u32 fade_in_len = 0;
+
+    mut_f32 mix     = f32(1.);
+    mut_f32 width   = f32(0.);
+    mut_f32 shuffle = f32(0.);
+    mut_f32 contour = f32(0.01);
+
+    mut_u8 step_pos       = 0;
+    mut_u8 step_count     = 16;
+    mut_u8 ch             = TranceGate::L;
+    bool is_shuffle       = false;
+    bool is_denormal_safe = false;
+};
+
+template <typename StepStorage>
+struct CompactTranceGateImpl final
+{
+    using Gate = CompactTranceGate<StepStorage>;
+
+    /**
+     * @brief Initialises the trance gate.
+     */
+    static Gate create();
+
+    /**
+     * @brief Returns the memory footprint of one instance in [bytes]. The
+     * gate does not allocate, so this is all memory an instance needs.
+     */
+    static constexpr std::size_t footprint() { return sizeof(Gate); }
+
+    /**
+     * @brief Processes one audio frame (4 channels).
+     */
+    static void process(Gate& gate, AudioFrame const& in, AudioFrame& out);
+
+    /**
+     * @brief Processes a block of audio frames (4 channels). In denormal safe
+     * mode FTZ/DAZ is enabled for the duration of the block.
+     */
+    static void process_block(Gate& gate,
+                              AudioFrame const* in,
+                              AudioFrame* out,
+                              i32 num_frames);
+
+    /**
+     * @brief Sets the sample rate in [Hz].
+     */
+    static void set_sample_rate(Gate& gate, f32 value);
+
+    /**
+     * @brief Sets the tempo in [BPM].
+     */
+    static void set_tempo(Gate& gate, f32 value);
+
+    /**
+     * @brief Triggers the trance gate.
+     * @param delay_len Note length of the delay until the gate starts
+     * @param fade_in_len Note length of the fade in
+     */
+    static void trigger(Gate& gate,
+                        f32 delay_len   = f32(0.),
+                        f32 fade_in_len = f32(0.));
+
+    /**
+     * @brief Resets filters and values.
+     */
+    static void reset(Gate& gate);
+
+    /**
+     * @brief Returns the current step position.
+     */
+    static i32 get_step_pos(Gate const& gate) { return gate.step_pos; }
+
+    /**
+     * @brief Sets the pattern length in steps.
+     */
+    static void set_step_count(Gate& gate, i32 value);
+
+    /**
+     * @brief Sets the amount [normalised] of a step, see StepStorageImpl.
+     */
+    static void
+    set_step(Gate& gate, i32 channel, i32 step, f32 value_normalised)
+    {
+        StepStorageImpl::set(gate.steps, channel, step, value_normalised);
+    }
+
+    /**
+     * @brief Sets the note length of a step. e.g. for 1/32th length, pass in
+     * 0.03125
+     */
+    static void set_step_len(Gate& gate, f32 value_note_len);
+
+    /**
+     * @brief Sets the mix [normalised] of the trance gate.
+     */
+    static void set_mix(Gate& gate, f32 value) { gate.mix = value; }
+
+    /**
+     * @brief Sets the duration in [seconds] of attack and release slope.
+     */
+    static void set_contour(Gate& gate, f32 value_seconds);
+
+    /**
+     * @brief Set the gate to either mono or stereo.
+     */
+    static void set_stereo_mode(Gate& gate, bool value)
+    {
+        gate.ch = value ? TranceGate::R : TranceGate::L;
+    }
+
+    /**
+     * @brief Sets the amount [normalised] of stereo effect.
+     */
+    static void set_width(Gate& gate, f32 value_normalised)
+    {
+        gate.width = f32(1.) - value_normalised;
+    }
+
+    /**
+     * @brief Sets the amount [normalised] of shuffle.
+     */
+    static void set_shuffle_amount(Gate& gate, f32 value)
+    {
+        gate.shuffle = value;
+    }
+
+    /**
+     * @brief Enables the denormal safe mode, see
+     * TranceGateImpl::set_denormal_safe.
+     */
+    static void set_denormal_safe(Gate& gate, bool value)
+    {
+        gate.is_denormal_safe = value;
+    }
+
+private:
+    static void update_contour(Gate& gate);
+    static void update_shuffle(Gate& gate);
+};
+
+using QuantizedTranceGate     = CompactTranceGate<QuantizedSteps>;
+using QuantizedTranceGateImpl = CompactTranceGateImpl<QuantizedSteps>;
+using BinaryTranceGate        = CompactTranceGate<BinarySteps>;
+using BinaryTranceGateImpl    = CompactTranceGateImpl<BinarySteps>;
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
@@ -0,0 +1,44 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/types.h"
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+/**
+ * cpu_dispatch
+ *
+ * The block processing kernels are compiled for several instruction sets.
+ * The best one supported by the CPU and OS is selected once at startup.
+ */
+
+enum class Isa : mut_i32
+{
+    Scalar = 0,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @brief Returns the best instruction set supported by the CPU, the OS and
+ * this build.
+ */
+Isa detect_isa();
+
+/**
+ * @brief Returns the instruction set of the kernels currently in use.
+ */
+Isa get_active_isa();
+
+/**
+ * @brief Forces the kernels of a specific instruction set, e.g. for testing.
+ * Do not call it while audio is processed.
+ * @return Returns false, if the instruction set is not supported
+ */
+bool force_isa(Isa isa);
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
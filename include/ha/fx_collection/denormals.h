@@ -0,0 +1,44 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/types.h"
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+/**
+ * scoped_flush_denormals
+ *
+ * Enables flush-to-zero (FTZ) and denormals-are-zero (DAZ) on the calling
+ * thread for the lifetime of the object. The previous floating point control
+ * state of the caller is restored in the destructor. Put it on the stack
+ * around the processing of an audio block. On x86 CPUs without DAZ support
+ * only FTZ is enabled.
+ */
+
+class ScopedFlushDenormals final
+{
+public:
+    ScopedFlushDenormals();
+    ~ScopedFlushDenormals();
+
+    ScopedFlushDenormals(ScopedFlushDenormals const&) = delete;
+    ScopedFlushDenormals& operator=(ScopedFlushDenormals const&) = delete;
+
+private:
+    mut_u64 saved_state = 0;
+};
+
+/**
+ * @brief Returns true, if the target supports setting FTZ/DAZ at runtime.
+ */
+bool is_flush_denormals_supported();
+
+/**
+ * @brief Returns true, if FTZ is currently enabled on the calling thread.
+ */
+bool is_flush_denormals_enabled();
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
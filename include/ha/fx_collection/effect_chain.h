@@ -0,0 +1,96 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/types.h"
+#include <tuple>
+#include <utility>
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+/**
+ * effect_chain
+ *
+ * Chains effects following the context plus static methods pattern at
+ * compile time. All effects are processed frame by frame inside one loop,
+ * so intermediate frames never go back to memory.
+ *
+ * using Chain = EffectChainImpl<Effect<TranceGate, TranceGateImpl>,
+ *                               Effect<GainPan, GainPanImpl>>;
+ */
+
+template <typename ContextType, typename ImplType>
+struct Effect
+{
+    using Context = ContextType;
+    using Impl    = ImplType;
+};
+
+template <typename... Effects>
+struct EffectChain
+{
+    using Contexts = std::tuple<typename Effects::Context...>;
+    Contexts contexts;
+};
+
+template <typename... Effects>
+struct EffectChainImpl final
+{
+    using Chain = EffectChain<Effects...>;
+
+    /**
+     * @brief Initialises the chain by creating the context of every effect.
+     */
+    static Chain create() { return {{Effects::Impl::create()...}}; }
+
+    /**
+     * @brief Returns the context of the effect at Index for setting its
+     * parameters through the effect's static methods.
+     */
+    template <std::size_t Index>
+    static auto& get(Chain& chain)
+    {
+        return std::get<Index>(chain.contexts);
+    }
+
+    /**
+     * @brief Processes one audio frame (4 channels) through all effects.
+     */
+    static void process(Chain& chain, AudioFrame const& in, AudioFrame& out)
+    {
+        out = in;
+        process(chain, out, std::index_sequence_for<Effects...>{});
+    }
+
+    /**
+     * @brief Processes a block of audio frames (4 channels) in a single pass.
+     */
+    static void process_block(Chain& chain,
+                              AudioFrame const* in,
+                              AudioFrame* out,
+                              i32 num_frames)
+    {
+        for (mut_i32 i = 0; i < num_frames; ++i)
+            process(chain, in[i], out[i]);
+    }
+
+private:
+    template <std::size_t... Indices>
+    static void
+    process(Chain& chain, AudioFrame& frame, std::index_sequence<Indices...>)
+    {
+        (process_effect<Effects>(std::get<Indices>(chain.contexts), frame),
+         ...);
+    }
+
+    template <typename E>
+    static void process_effect(typename E::Context& context, AudioFrame& frame)
+    {
+        AudioFrame const in = frame;
+        E::Impl::process(context, in, frame);
+    }
+};
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
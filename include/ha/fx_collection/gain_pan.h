@@ -0,0 +1,63 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/types.h"
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+/**
+ * gain_pan
+ */
+
+struct GainPan
+{
+    static constexpr i32 L = 0;
+    static constexpr i32 R = 1;
+
+    mut_f32 gain    = f32(1.);
+    mut_f32 pan     = f32(0.5);
+    // cos and sin of pan * pi / 2, -3dB per channel at center.
+    mut_f32 gain_le = f32(0.70710678);
+    mut_f32 gain_ri = f32(0.70710678);
+};
+
+struct GainPanImpl final
+{
+    /**
+     * @brief Initialises unity gain and center pan, which is -3dB (cos(pi / 4))
+     * on each channel.
+     */
+    static GainPan create();
+
+    /**
+     * @brief Processes one audio frame (4 channels). Only the first two
+     * channels are modified, the others are passed through.
+     */
+    static void
+    process(GainPan const& gain_pan, AudioFrame const& in, AudioFrame& out)
+    {
+        out = in;
+        out.data[GainPan::L] *= gain_pan.gain_le;
+        out.data[GainPan::R] *= gain_pan.gain_ri;
+    }
+
+    /**
+     * @brief Sets the gain.
+     * @param value Defining the [linear] gain
+     */
+    static void set_gain(GainPan& gain_pan, f32 value);
+
+    /**
+     * @brief Sets the constant power panning.
+     * @param value Defining the pan [normalised], 0.5 is center
+     */
+    static void set_pan(GainPan& gain_pan, f32 value_normalised);
+
+private:
+    static void update_gains(GainPan& gain_pan);
+};
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
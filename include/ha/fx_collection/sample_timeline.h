@@ -0,0 +1,105 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/types.h"
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+/**
+ * sample_timeline
+ *
+ * Drift free step timing based on a 64 bit sample counter. The step length
+ * is kept as a fraction step_len_num / step_len_den [samples], computed from
+ * note length, tempo and sample rate. The position inside the current step
+ * is an integer remainder, so no rounding error accumulates over time and
+ * step boundaries can be computed exactly.
+ *
+ * Tempo is resolved to 1/1000 BPM, the sample rate to 1 Hz and note lengths
+ * to 1/3072 of a whole note, which covers normal, triolic and dotted notes
+ * down to 1/128.
+ */
+
+struct SampleTimeline
+{
+    static constexpr u64 TEMPO_SCALE     = 1000;
+    static constexpr u64 NOTE_TICKS      = 3072;
+    static constexpr u64 WHOLE_NOTE_SECS = 240; // at 1 BPM: 4 * 60 seconds
+
+    mut_u64 sample_pos = 0;
+    mut_u64 step_index = 0;
+    // Position inside the current step, always less than step_len_num.
+    mut_u64 step_remainder = 0;
+    mut_u64 step_len_num   = 1;
+    mut_u64 step_len_den   = 1;
+
+    mut_u64 tempo       = 120 * TEMPO_SCALE;
+    mut_u64 sample_rate = 44100;
+    mut_u64 note_ticks  = NOTE_TICKS / 32;
+};
+
+struct SampleTimelineImpl final
+{
+    /**
+     * @brief Initialises the timeline with 120 BPM, 44.1kHz and 1/32 steps.
+     */
+    static SampleTimeline create();
+
+    /**
+     * @brief Advances the timeline by num_samples.
+     * @return Returns the number of step boundaries crossed
+     */
+    static u64 advance(SampleTimeline& timeline, u32 num_samples);
+
+    /**
+     * @brief Returns the number of samples until the next step starts. A step
+     * boundary lies inside a block of n samples, if this is less or equal n.
+     */
+    static u64 samples_until_next_step(SampleTimeline const& timeline);
+
+    /**
+     * @brief Returns the position inside the current step [0 - 1).
+     */
+    static f64 get_step_phase(SampleTimeline const& timeline);
+
+    /**
+     * @brief Moves the timeline to an absolute sample position, assuming the
+     * current tempo since position zero.
+     */
+    static void set_sample_pos(SampleTimeline& timeline, u64 value);
+
+    /**
+     * @brief Moves the timeline to a musical position [quarter notes]. The
+     * position is converted to samples assuming the current tempo since
+     * position zero, so it is only exact if the tempo never changed.
+     */
+    static void set_project_time_music(SampleTimeline& timeline, f64 value);
+
+    /**
+     * @brief Restarts the current step at phase zero.
+     */
+    static void restart_step(SampleTimeline& timeline);
+
+    /**
+     * @brief Sets the tempo in [BPM]. The phase of the current step is kept.
+     */
+    static void set_tempo(SampleTimeline& timeline, f64 value);
+
+    /**
+     * @brief Sets the sample rate in [Hz]. The phase of the current step is
+     * kept.
+     */
+    static void set_sample_rate(SampleTimeline& timeline, f64 value);
+
+    /**
+     * @brief Sets the note length of a step, e.g. 0.03125 for 1/32.
+     */
+    static void set_note_len(SampleTimeline& timeline, f64 value_note_len);
+
+private:
+    static void update_step_len(SampleTimeline& timeline);
+};
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
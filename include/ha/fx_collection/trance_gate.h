@@ -4,8 +4,11 @@
 
 #include "ha/dsp_tool_box/filtering/one_pole.h"
 #include "ha/dsp_tool_box/modulation/modulation_phase.h"
+#include "ha/fx_collection/sample_timeline.h"
+#include "ha/fx_collection/triple_buffer.h"
 #include "ha/fx_collection/types.h"
 #include <array>
+#include <cstddef>
 #include <vector>
 
 namespace ha::fx_collection {
@@ -15,6 +18,9 @@ namespace ha::fx_collection {
  * trance_gate
  */
 
+struct TranceGateMeter;
+using TranceGateMeterBuffer = TripleBuffer<TranceGateMeter>;
+
 struct TranceGate
 {
     static constexpr i32 NUM_CHANNELS  = 2;
@@ -26,8 +32,10 @@ struct TranceGate
     using StepValues     = std::array<mut_f32, MAX_NUM_STEPS>;
     using ChannelSteps   = std::array<StepValues, NUM_CHANNELS>;
     using ContourFilters = std::array<dtb::filtering::OnePole, NUM_CHANNELS>;
+    using GateGains      = std::array<mut_f32, NUM_CHANNELS>;
     alignas(BYTE_ALIGNMENT) ChannelSteps channel_steps;
     ContourFilters contour_filters;
+    GateGains gate_gains{f32(1.), f32(1.)};
 
     struct Step
     {
@@ -49,15 +57,40 @@ struct TranceGate
     mut_f32 step_phase_val    = f32(0.);
     mut_f32 fade_in_phase_val = f32(0.);
 
+    /*  Drives the step phase instead of step_phase when is_sample_accurate.
+        It only advances in that mode, so resync it after switching the mode.
+        This costs 64 bytes per instance and keeps tempo, sample rate and
+        note length a second time, in integer form.
+     */
+    SampleTimeline step_timeline;
+
     Step step_val;
-    mut_f32 mix            = f32(1.);
-    mut_f32 width          = f32(0.);
-    mut_f32 shuffle        = f32(0.);
-    mut_f32 contour        = f32(0.01);
-    mut_f32 sample_rate    = f32(44100.);
-    mut_i32 ch             = L;
+    mut_f32 mix             = f32(1.);
+    mut_f32 width           = f32(0.);
+    mut_f32 shuffle         = f32(0.);
+    mut_f32 contour         = f32(0.01);
+    mut_f32 sample_rate     = f32(44100.);
+    mut_i32 ch              = L;
+    bool is_delay_active    = false;
+    bool is_fade_in_active  = false;
+    bool is_denormal_safe   = false;
+    bool is_sample_accurate = false;
+};
+
+/**
+ * @brief Snapshot of the running trance gate, published once per block for
+ * UI and metering.
+ */
+struct TranceGateMeter
+{
+    mut_i32 step_pos       = 0;
+    mut_f32 step_phase     = f32(0.);
+    mut_f32 fade_in_phase  = f32(0.);
+    mut_f32 delay_phase    = f32(0.);
+    // True while the gate still waits for the delay to pass.
     bool is_delay_active   = false;
     bool is_fade_in_active = false;
+    TranceGate::GateGains gate_gains{f32(1.), f32(1.)};
 };
 
 struct TranceGateImpl final
@@ -67,12 +100,55 @@ struct TranceGateImpl final
      */
     static TranceGate create();
 
+    /**
+     * @brief Returns the memory footprint of one instance in [bytes]. The
+     * gate does not allocate, the meter buffer is owned by the caller.
+     */
+    static constexpr std::size_t footprint() { return sizeof(TranceGate); }
+
     /**
      * @brief Processes one audio frame (4 channels).
      */
     static void
     process(TranceGate& trance_gate, AudioFrame const& in, AudioFrame& out);
 
+    /**
+     * @brief Processes a block of audio frames (4 channels).
+     *
+     * The hot loops run in kernels selected for the CPU at startup, see
+     * cpu_dispatch.h. The output matches process within float rounding. Only
+     * long contours settle slightly closer to the step value, by up to 0.5%
+     * at 4s. In denormal safe mode FTZ/DAZ is enabled for the duration of the
+     * block and the caller's floating point state is restored afterwards.
+     *
+     * @param in Pointer to num_frames input frames
+     * @param out Pointer to num_frames output frames
+     */
+    static void process_block(TranceGate& trance_gate,
+                              AudioFrame const* in,
+                              AudioFrame* out,
+                              i32 num_frames);
+
+    /**
+     * @brief Processes a block of audio frames (4 channels) like above and
+     * calls end_block afterwards.
+     */
+    static void process_block(TranceGate& trance_gate,
+                              AudioFrame const* in,
+                              AudioFrame* out,
+                              i32 num_frames,
+                              TranceGateMeterBuffer& meter_buffer);
+
+    /**
+     * @brief Finishes a block of frames by publishing a TranceGateMeter. Call
+     * it after processing a block frame by frame, e.g. in an effect chain.
+     * Audio thread only, GUI threads read the meter buffer wait-free through
+     * TripleBufferImpl::fetch.
+     * @param meter_buffer Has exactly one trance gate writing to it
+     */
+    static void end_block(TranceGate const& trance_gate,
+                          TranceGateMeterBuffer& meter_buffer);
+
     /**
      * @brief Sets the sample rate in [Hz].
      */
@@ -84,10 +160,22 @@ struct TranceGateImpl final
     static void set_tempo(TranceGate& trance_gate, f32 value);
 
     /**
-     * @brief Updates the musical project time [quarter notes].
+     * @brief Updates the musical project time [quarter notes]. The sample
+     * accurate timing converts it to samples assuming the current tempo since
+     * position zero and moves the step position there. With tempo changes in
+     * the project, prefer update_project_time_samples.
      */
     static void update_project_time_music(TranceGate& trance_gate, f64 value);
 
+    /**
+     * @brief Updates the project time [samples]. Only the sample accurate
+     * timing uses it, see set_sample_accurate. The step position and phase
+     * are derived from the current tempo, as if it had been constant since
+     * position zero.
+     */
+    static void update_project_time_samples(TranceGate& trance_gate,
+                                            u64 value);
+
     /**
      * @brief Triggers the trance gate.
      *
@@ -113,7 +201,8 @@ struct TranceGateImpl final
     static void reset_step_pos(TranceGate& trance_gate, i32 value);
 
     /**
-     * @brief Returns the current step position.
+     * @brief Returns the current step position. Call it from the audio
+     * thread only, other threads read the TranceGateMeter instead.
      */
     static i32 get_step_pos(const TranceGate& trance_gate);
 
@@ -176,7 +265,38 @@ struct TranceGateImpl final
      */
     static void set_shuffle_amount(TranceGate& trance_gate, f32 value);
 
+    /**
+     * @brief Enables the denormal safe mode. Filter states decaying below
+     * an inaudible threshold are snapped to zero and process_block runs
+     * with FTZ/DAZ enabled.
+     */
+    static void set_denormal_safe(TranceGate& trance_gate, bool value)
+    {
+        trance_gate.is_denormal_safe = value;
+    }
+
+    /**
+     * @brief Enables the sample accurate step timing. Steps are then timed
+     * by a 64 bit sample counter and an exact rational step length instead of
+     * accumulating a float phase, see SampleTimeline. The sample counter
+     * only runs in this mode, call update_project_time_samples after enabling
+     * it during playback.
+     */
+    static void set_sample_accurate(TranceGate& trance_gate, bool value)
+    {
+        trance_gate.is_sample_accurate = value;
+    }
+
 private:
+    static void process_frames(TranceGate& trance_gate,
+                               AudioFrame const* in,
+                               AudioFrame* out,
+                               i32 num_frames);
+    static i32 compute_gate_values(TranceGate& trance_gate,
+                                   mut_f32* values_le,
+                                   mut_f32* values_ri,
+                                   mut_f32* mixes,
+                                   i32 max_frames);
     static void set_fade_in(TranceGate& trance_gate, f32 value);
     static void set_delay(TranceGate& trance_gate, f32 value);
     static void update_phases(TranceGate& trance_gate);
@@ -0,0 +1,96 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/types.h"
+#include <array>
+#include <atomic>
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+/**
+ * triple_buffer
+ *
+ * Wait-free single producer, single consumer exchange of a value. The
+ * writer (e.g. the audio thread) fills the back buffer and publishes it. The
+ * reader (e.g. a GUI thread) fetches the latest published buffer at any rate.
+ * Neither side ever blocks or sees a partially written value.
+ */
+
+template <typename T>
+struct TripleBuffer
+{
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr u32 INDEX_MASK              = 0x3;
+    static constexpr u32 NEW_DATA_FLAG           = 0x4;
+
+    std::array<T, 3> buffers{};
+
+    // Index of the buffer in between writer and reader plus NEW_DATA_FLAG.
+    alignas(CACHE_LINE_SIZE) std::atomic<mut_u32> middle{1};
+
+    // Owned by the writer.
+    alignas(CACHE_LINE_SIZE) mut_u32 back = 0;
+
+    // Owned by the reader.
+    alignas(CACHE_LINE_SIZE) mut_u32 front = 2;
+};
+
+struct TripleBufferImpl final
+{
+    /**
+     * @brief Returns the buffer the writer fills before calling publish.
+     */
+    template <typename T>
+    static T& get_write_buffer(TripleBuffer<T>& triple_buffer)
+    {
+        return triple_buffer.buffers[triple_buffer.back];
+    }
+
+    /**
+     * @brief Publishes the write buffer to the reader. Writer thread only.
+     */
+    template <typename T>
+    static void publish(TripleBuffer<T>& triple_buffer)
+    {
+        using TB = TripleBuffer<T>;
+
+        u32 const prev = triple_buffer.middle.exchange(
+            triple_buffer.back | TB::NEW_DATA_FLAG, std::memory_order_acq_rel);
+        triple_buffer.back = prev & TB::INDEX_MASK;
+    }
+
+    /**
+     * @brief Fetches the latest published buffer. Reader thread only.
+     * @return Returns true, if new data has been published since the last
+     * fetch
+     */
+    template <typename T>
+    static bool fetch(TripleBuffer<T>& triple_buffer)
+    {
+        using TB = TripleBuffer<T>;
+
+        if (!(triple_buffer.middle.load(std::memory_order_relaxed) &
+              TB::NEW_DATA_FLAG))
+            return false;
+
+        u32 const prev = triple_buffer.middle.exchange(
+            triple_buffer.front, std::memory_order_acq_rel);
+        triple_buffer.front = prev & TB::INDEX_MASK;
+
+        return true;
+    }
+
+    /**
+     * @brief Returns the buffer last fetched by the reader.
+     */
+    template <typename T>
+    static T const& get_read_buffer(TripleBuffer<T> const& triple_buffer)
+    {
+        return triple_buffer.buffers[triple_buffer.front];
+    }
+};
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
@@ -20,6 +20,15 @@ using mut_f32 = std::remove_const<f32>::type;
 using f64     = double const;
 using mut_f64 = std::remove_const<f64>::type;
 
+using u8     = std::uint8_t const;
+using mut_u8 = std::remove_const<u8>::type;
+
+using u32     = std::uint32_t const;
+using mut_u32 = std::remove_const<u32>::type;
+
+using u64     = std::uint64_t const;
+using mut_u64 = std::remove_const<u64>::type;
+
 using audio_sample = mut_real;
 
 constexpr std::size_t NUM_CHANNELS   = 4;
@@ -0,0 +1,260 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/compact_trance_gate.h"
+#include "detail/gate_kernels.h"
+#include "detail/shuffle_note.h"
+#include "ha/fx_collection/denormals.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+static constexpr u32 ONE_SAMPLE = 1;
+
+//------------------------------------------------------------------------
+static u32 note_len_to_samples(SampleTimeline const& timeline, f32 note_len)
+{
+    f64 tempo   = f64(timeline.tempo) / SampleTimeline::TEMPO_SCALE;
+    f64 seconds = note_len * SampleTimeline::WHOLE_NOTE_SECS / tempo;
+
+    return u32(std::llround(seconds * timeline.sample_rate));
+}
+
+//------------------------------------------------------------------------
+//	StepStorageImpl
+//------------------------------------------------------------------------
+void StepStorageImpl::set(QuantizedSteps& steps,
+                          i32 channel,
+                          i32 step,
+                          f32 value_normalised)
+{
+    f32 value = std::clamp(value_normalised, f32(0.), f32(1.));
+    steps.values.at(channel).at(step) =
+        mut_u8(std::lround(value * QuantizedSteps::MAX_VALUE));
+}
+
+//------------------------------------------------------------------------
+void StepStorageImpl::set(BinarySteps& steps,
+                          i32 channel,
+                          i32 step,
+                          f32 value_normalised)
+{
+    // Same range check as the std::array::at of QuantizedSteps.
+    if (step < 0 || step >= TranceGate::MAX_NUM_STEPS)
+        throw std::out_of_range("BinarySteps: step out of range");
+
+    u32 mask   = u32(1) << step;
+    auto& bits = steps.bits.at(channel);
+    bits       = value_normalised >= f32(0.5) ? bits | mask : bits & ~mask;
+}
+
+//------------------------------------------------------------------------
+//	CompactTranceGateImpl
+//------------------------------------------------------------------------
+template <typename StepStorage>
+CompactTranceGate<StepStorage> CompactTranceGateImpl<StepStorage>::create()
+{
+    Gate gate;
+    gate.timeline = SampleTimelineImpl::create();
+    update_contour(gate);
+    update_shuffle(gate);
+
+    return gate;
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::process(Gate& gate,
+                                                 AudioFrame const& in,
+                                                 AudioFrame& out)
+{
+    using OnePoleImpl = dtb::filtering::OnePoleImpl;
+
+    auto& timeline = gate.timeline;
+    auto& filters  = gate.contour_filters;
+
+    // Pass through while delaying. The first step starts after the delay.
+    if (timeline.sample_pos < gate.delay_len)
+    {
+        SampleTimelineImpl::advance(timeline, ONE_SAMPLE);
+        if (timeline.sample_pos == gate.delay_len)
+            SampleTimelineImpl::restart_step(timeline);
+
+        out = in;
+        return;
+    }
+
+    i32 pos          = gate.step_pos;
+    mut_f32 value_le = StepStorageImpl::get(gate.steps, TranceGate::L, pos);
+    mut_f32 value_ri = StepStorageImpl::get(gate.steps, gate.ch, pos);
+
+    // Keep order here, same as TranceGate. Mix must be applied last.
+    constexpr f32 MAX_DELAY = f32(3. / 4.);
+    if (gate.is_shuffle)
+    {
+        f32 phase  = f32(SampleTimelineImpl::get_step_phase(timeline));
+        f32 factor = phase > gate.shuffle * MAX_DELAY ? f32(1.) : f32(0.);
+        value_le *= factor;
+        value_ri *= factor;
+    }
+
+    value_le = std::max(value_le, value_ri * gate.width);
+    value_ri = std::max(value_ri, value_le * gate.width);
+
+    value_le = OnePoleImpl::process(filters[TranceGate::L], value_le);
+    value_ri = OnePoleImpl::process(filters[TranceGate::R], value_ri);
+    if (gate.is_denormal_safe)
+    {
+        detail::flush_denormal(filters[TranceGate::L], value_le);
+        detail::flush_denormal(filters[TranceGate::R], value_ri);
+    }
+
+    mut_f32 mix = gate.mix;
+    if (gate.fade_in_len > 0)
+    {
+        u64 elapsed = std::min(timeline.sample_pos - gate.delay_len,
+                               u64(gate.fade_in_len));
+        mix *= f32(elapsed) / f32(gate.fade_in_len);
+    }
+
+    value_le = (f32(1.) - mix) + value_le * mix;
+    value_ri = (f32(1.) - mix) + value_ri * mix;
+
+    out.data[TranceGate::L] = in.data[TranceGate::L] * value_le;
+    out.data[TranceGate::R] = in.data[TranceGate::R] * value_ri;
+
+    if (SampleTimelineImpl::advance(timeline, ONE_SAMPLE) > 0)
+    {
+        ++gate.step_pos;
+        if (!(gate.step_pos < gate.step_count))
+            gate.step_pos = 0;
+
+        update_shuffle(gate);
+    }
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::process_block(Gate& gate,
+                                                       AudioFrame const* in,
+                                                       AudioFrame* out,
+                                                       i32 num_frames)
+{
+    auto const process_frames = [&]() {
+        for (mut_i32 i = 0; i < num_frames; ++i)
+            process(gate, in[i], out[i]);
+    };
+
+    if (gate.is_denormal_safe)
+    {
+        ScopedFlushDenormals const flush_denormals;
+        process_frames();
+    }
+    else
+    {
+        process_frames();
+    }
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::set_sample_rate(Gate& gate, f32 value)
+{
+    SampleTimelineImpl::set_sample_rate(gate.timeline, value);
+    update_contour(gate);
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::set_tempo(Gate& gate, f32 value)
+{
+    SampleTimelineImpl::set_tempo(gate.timeline, value);
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::trigger(Gate& gate,
+                                                 f32 delay_len,
+                                                 f32 fade_in_len)
+{
+    gate.delay_len   = note_len_to_samples(gate.timeline, delay_len);
+    gate.fade_in_len = note_len_to_samples(gate.timeline, fade_in_len);
+
+    SampleTimelineImpl::set_sample_pos(gate.timeline, 0);
+    gate.step_pos = 0;
+    update_shuffle(gate);
+
+    // Like TranceGate, filters are only reset here when delay is active.
+    if (gate.delay_len > 0)
+        reset(gate);
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::reset(Gate& gate)
+{
+    using OnePoleImpl = dtb::filtering::OnePoleImpl;
+
+    f32 reset_value = gate.delay_len > 0 ? f32(1.) : f32(0.);
+    for (auto& filter : gate.contour_filters)
+        OnePoleImpl::reset(filter, reset_value);
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::set_step_count(Gate& gate, i32 value)
+{
+    gate.step_count = mut_u8(std::clamp(
+        value, TranceGate::MIN_NUM_STEPS, TranceGate::MAX_NUM_STEPS));
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::set_step_len(Gate& gate,
+                                                      f32 value_note_len)
+{
+    SampleTimelineImpl::set_note_len(gate.timeline, value_note_len);
+    update_shuffle(gate);
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::set_contour(Gate& gate,
+                                                     f32 value_seconds)
+{
+    if (gate.contour == value_seconds)
+        return;
+
+    gate.contour = value_seconds;
+    update_contour(gate);
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::update_contour(Gate& gate)
+{
+    using OnePoleImpl = dtb::filtering::OnePoleImpl;
+
+    f32 pole =
+        OnePoleImpl::tau_to_pole(gate.contour, f32(gate.timeline.sample_rate));
+    for (auto& filter : gate.contour_filters)
+        OnePoleImpl::update_pole(filter, pole);
+}
+
+//------------------------------------------------------------------------
+template <typename StepStorage>
+void CompactTranceGateImpl<StepStorage>::update_shuffle(Gate& gate)
+{
+    f32 note_len =
+        f32(gate.timeline.note_ticks) / f32(SampleTimeline::NOTE_TICKS);
+    gate.is_shuffle = detail::is_shuffle_note(gate.step_pos, note_len);
+}
+
+//------------------------------------------------------------------------
+template struct CompactTranceGateImpl<QuantizedSteps>;
+template struct CompactTranceGateImpl<BinarySteps>;
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
@@ -0,0 +1,130 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/denormals.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define HA_FX_COLLECTION_DENORMALS_SSE 1
+#include <cstring>
+#include <xmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__)
+#define HA_FX_COLLECTION_DENORMALS_AARCH64 1
+#endif
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+#if defined(HA_FX_COLLECTION_DENORMALS_SSE)
+// MXCSR bits: FTZ is bit 15, DAZ is bit 6.
+static constexpr u64 FTZ_MASK = 0x8000;
+static constexpr u64 DAZ_MASK = 0x0040;
+
+/*  Early SSE CPUs do not support DAZ and setting it raises #GP. Support is
+    reported in MXCSR_MASK, stored at byte 28 of the FXSAVE area. A mask of
+    zero means the default 0xFFBF, which has no DAZ.
+ */
+static u64 read_mxcsr_mask()
+{
+    constexpr u32 DEFAULT_MXCSR_MASK = 0xFFBF;
+    constexpr i32 MXCSR_MASK_OFFSET  = 28;
+
+    alignas(16) unsigned char fxsave_area[512] = {};
+#if defined(_MSC_VER)
+    _fxsave(fxsave_area);
+#else
+    __asm__ volatile("fxsave %0" : "=m"(fxsave_area));
+#endif
+
+    mut_u32 mask = 0;
+    std::memcpy(&mask, fxsave_area + MXCSR_MASK_OFFSET, sizeof(mask));
+    return mask != 0 ? mask : DEFAULT_MXCSR_MASK;
+}
+
+static u64 get_ftz_daz_mask()
+{
+    static u64 const mask = FTZ_MASK | (read_mxcsr_mask() & DAZ_MASK);
+    return mask;
+}
+
+static u64 read_fp_state()
+{
+    return _mm_getcsr();
+}
+
+static void write_fp_state(u64 value)
+{
+    _mm_setcsr(static_cast<unsigned int>(value));
+}
+#elif defined(HA_FX_COLLECTION_DENORMALS_AARCH64)
+// FPCR bit 24 (FZ) flushes both inputs and results on AArch64.
+static constexpr u64 FTZ_MASK = u64(1) << 24;
+
+static u64 get_ftz_daz_mask()
+{
+    return FTZ_MASK;
+}
+
+static u64 read_fp_state()
+{
+    mut_u64 value = 0;
+    asm volatile("mrs %0, fpcr" : "=r"(value));
+    return value;
+}
+
+static void write_fp_state(u64 value)
+{
+    asm volatile("msr fpcr, %0" : : "r"(value));
+}
+#else
+static constexpr u64 FTZ_MASK = 0;
+
+static u64 get_ftz_daz_mask()
+{
+    return 0;
+}
+
+static u64 read_fp_state()
+{
+    return 0;
+}
+
+static void write_fp_state(u64)
+{
+}
+#endif
+
+//------------------------------------------------------------------------
+//	ScopedFlushDenormals
+//------------------------------------------------------------------------
+ScopedFlushDenormals::ScopedFlushDenormals()
+: saved_state(read_fp_state())
+{
+    u64 const ftz_daz_mask = get_ftz_daz_mask();
+    if ((saved_state & ftz_daz_mask) != ftz_daz_mask)
+        write_fp_state(saved_state | ftz_daz_mask);
+}
+
+//------------------------------------------------------------------------
+ScopedFlushDenormals::~ScopedFlushDenormals()
+{
+    u64 const ftz_daz_mask = get_ftz_daz_mask();
+    if ((saved_state & ftz_daz_mask) != ftz_daz_mask)
+        write_fp_state(saved_state);
+}
+
+//------------------------------------------------------------------------
+bool is_flush_denormals_supported()
+{
+    return FTZ_MASK != 0;
+}
+
+//------------------------------------------------------------------------
+bool is_flush_denormals_enabled()
+{
+    return is_flush_denormals_supported() && (read_fp_state() & FTZ_MASK);
+}
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
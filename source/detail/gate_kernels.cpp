@@ -0,0 +1,183 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "gate_kernels.h"
+
+#if defined(HA_FX_COLLECTION_X86_KERNELS)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace ha::fx_collection {
+namespace detail {
+
+//-----------------------------------------------------------------------------
+static constexpr GateKernels SCALAR_KERNELS{
+    scalar::apply_width, scalar::apply_contour, scalar::apply_mix,
+    scalar::apply_gains};
+
+#if defined(HA_FX_COLLECTION_X86_KERNELS)
+static constexpr GateKernels SSE2_KERNELS{
+    sse2::apply_width, sse2::apply_contour, sse2::apply_mix,
+    sse2::apply_gains};
+
+static constexpr GateKernels AVX2_KERNELS{
+    avx2::apply_width, avx2::apply_contour, avx2::apply_mix,
+    avx2::apply_gains};
+
+static constexpr GateKernels AVX512_KERNELS{
+    avx512::apply_width, avx512::apply_contour, avx512::apply_mix,
+    avx512::apply_gains};
+
+//-----------------------------------------------------------------------------
+struct CpuidRegs
+{
+    mut_u32 eax = 0;
+    mut_u32 ebx = 0;
+    mut_u32 ecx = 0;
+    mut_u32 edx = 0;
+};
+
+//-----------------------------------------------------------------------------
+static CpuidRegs cpuid(u32 leaf, u32 sub_leaf)
+{
+    CpuidRegs regs;
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuidex(info, int(leaf), int(sub_leaf));
+    regs.eax = u32(info[0]);
+    regs.ebx = u32(info[1]);
+    regs.ecx = u32(info[2]);
+    regs.edx = u32(info[3]);
+#else
+    __cpuid_count(leaf, sub_leaf, regs.eax, regs.ebx, regs.ecx, regs.edx);
+#endif
+    return regs;
+}
+
+//-----------------------------------------------------------------------------
+static u64 read_xcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    mut_u32 eax = 0;
+    mut_u32 edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (u64(edx) << 32) | eax;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+static Isa detect_x86_isa()
+{
+    // Feature bits, see the Intel SDM, CPUID instruction.
+    constexpr u32 SSE2_BIT    = 1u << 26; // leaf 1, edx
+    constexpr u32 OSXSAVE_BIT = 1u << 27; // leaf 1, ecx
+    constexpr u32 AVX_BIT     = 1u << 28; // leaf 1, ecx
+    constexpr u32 AVX2_BIT    = 1u << 5;  // leaf 7, ebx
+    constexpr u32 AVX512F_BIT = 1u << 16; // leaf 7, ebx
+    // XCR0 bits the OS sets when it saves the register state.
+    constexpr u64 XMM_YMM_STATE = 0x06;
+    constexpr u64 ZMM_STATE     = 0xE0;
+
+    u32 const max_leaf = cpuid(0, 0).eax;
+    if (max_leaf < 1)
+        return Isa::Scalar;
+
+    CpuidRegs const leaf_1 = cpuid(1, 0);
+    if (!(leaf_1.edx & SSE2_BIT))
+        return Isa::Scalar;
+
+    if (max_leaf < 7 || !(leaf_1.ecx & OSXSAVE_BIT) || !(leaf_1.ecx & AVX_BIT))
+        return Isa::SSE2;
+
+    u64 const xcr0 = read_xcr0();
+    if ((xcr0 & XMM_YMM_STATE) != XMM_YMM_STATE)
+        return Isa::SSE2;
+
+    CpuidRegs const leaf_7 = cpuid(7, 0);
+    if (!(leaf_7.ebx & AVX2_BIT))
+        return Isa::SSE2;
+
+    if ((leaf_7.ebx & AVX512F_BIT) && (xcr0 & ZMM_STATE) == ZMM_STATE)
+        return Isa::AVX512;
+
+    return Isa::AVX2;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+struct ActiveKernels
+{
+    Isa isa;
+    GateKernels const* kernels;
+};
+
+//-----------------------------------------------------------------------------
+static ActiveKernels& get_active_kernels()
+{
+    // Selected once, on first use.
+    static ActiveKernels active{detect_isa(), get_gate_kernels(detect_isa())};
+    return active;
+}
+
+//-----------------------------------------------------------------------------
+GateKernels const& get_gate_kernels()
+{
+    return *get_active_kernels().kernels;
+}
+
+//-----------------------------------------------------------------------------
+GateKernels const* get_gate_kernels(Isa isa)
+{
+    if (isa > detect_isa())
+        return nullptr;
+
+    switch (isa)
+    {
+        case Isa::Scalar: return &SCALAR_KERNELS;
+#if defined(HA_FX_COLLECTION_X86_KERNELS)
+        case Isa::SSE2: return &SSE2_KERNELS;
+        case Isa::AVX2: return &AVX2_KERNELS;
+        case Isa::AVX512: return &AVX512_KERNELS;
+#endif
+        default: return nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------
+} // namespace detail
+
+//-----------------------------------------------------------------------------
+Isa detect_isa()
+{
+#if defined(HA_FX_COLLECTION_X86_KERNELS)
+    static Isa const isa = detail::detect_x86_isa();
+    return isa;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+Isa get_active_isa()
+{
+    return detail::get_active_kernels().isa;
+}
+
+//-----------------------------------------------------------------------------
+bool force_isa(Isa isa)
+{
+    auto const* kernels = detail::get_gate_kernels(isa);
+    if (!kernels)
+        return false;
+
+    detail::get_active_kernels() = {isa, kernels};
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+} // namespace ha::fx_collection
@@ -0,0 +1,188 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#pragma once
+
+#include "ha/fx_collection/cpu_dispatch.h"
+#include "ha/fx_collection/types.h"
+
+namespace ha::dtb::filtering {
+struct OnePole;
+} // namespace ha::dtb::filtering
+
+namespace ha::fx_collection::detail {
+
+//-----------------------------------------------------------------------------
+// Roughly -300dB, far below anything audible but still a normal float.
+constexpr f32 DENORMAL_THRESHOLD = f32(1e-15);
+
+/**
+ * @brief Coefficients of the one pole contour filters,
+ * y = gain * x + pole * y[-1].
+ */
+struct ContourCoeffs
+{
+    mut_f32 pole = f32(0.);
+    mut_f32 gain = f32(1.);
+};
+
+/**
+ * @brief Hot loops of the trance gate block processing. All kernels work on
+ * num_frames gate values per channel, stored one after another. The contour
+ * kernels continue from and update the filter states state_le and state_ri.
+ */
+using ApplyWidthFunc   = void (*)(f32 width,
+                                mut_f32* values_le,
+                                mut_f32* values_ri,
+                                i32 num_frames);
+using ApplyContourFunc = void (*)(ContourCoeffs const& coeffs,
+                                  bool is_denormal_safe,
+                                  mut_f32& state_le,
+                                  mut_f32& state_ri,
+                                  mut_f32* values_le,
+                                  mut_f32* values_ri,
+                                  i32 num_frames);
+using ApplyMixFunc     = void (*)(f32 const* mixes,
+                              mut_f32* values_le,
+                              mut_f32* values_ri,
+                              i32 num_frames);
+using ApplyGainsFunc   = void (*)(f32 const* values_le,
+                                f32 const* values_ri,
+                                AudioFrame const* in,
+                                AudioFrame* out,
+                                i32 num_frames);
+
+struct GateKernels
+{
+    ApplyWidthFunc apply_width     = nullptr;
+    ApplyContourFunc apply_contour = nullptr;
+    ApplyMixFunc apply_mix         = nullptr;
+    ApplyGainsFunc apply_gains     = nullptr;
+};
+
+/**
+ * @brief Returns the kernels selected at startup or by force_isa.
+ */
+GateKernels const& get_gate_kernels();
+
+/**
+ * @brief Returns the kernels of a specific instruction set.
+ * @return Returns nullptr, if the instruction set is not supported
+ */
+GateKernels const* get_gate_kernels(Isa isa);
+
+/**
+ * @brief Fills the weights of the contour recursion unrolled over num_lanes
+ * frames: y[k] = decay[k] * y[-1] + sum of weight(k - j) * x[j] for j <= k.
+ * Weights far below DENORMAL_THRESHOLD are set to zero.
+ * @param decay num_lanes weights of the previous state, pole^(k + 1)
+ * @param taps 2 * num_lanes - 1 weights. num_lanes - 1 zeros followed by
+ * gain * pole^k, so the lane weights of x[j] start at num_lanes - 1 - j
+ */
+void make_contour_taps(ContourCoeffs const& coeffs,
+                       i32 num_lanes,
+                       mut_f32* decay,
+                       mut_f32* taps);
+
+/**
+ * @brief Snaps the filter state to zero when it decays below an inaudible
+ * threshold. The value is the last filter output resp. its state.
+ */
+void flush_denormal(dtb::filtering::OnePole& filter, mut_f32& value);
+
+//-----------------------------------------------------------------------------
+namespace scalar {
+void apply_width(f32 width,
+                 mut_f32* values_le,
+                 mut_f32* values_ri,
+                 i32 num_frames);
+void apply_contour(ContourCoeffs const& coeffs,
+                   bool is_denormal_safe,
+                   mut_f32& state_le,
+                   mut_f32& state_ri,
+                   mut_f32* values_le,
+                   mut_f32* values_ri,
+                   i32 num_frames);
+void apply_mix(f32 const* mixes,
+               mut_f32* values_le,
+               mut_f32* values_ri,
+               i32 num_frames);
+void apply_gains(f32 const* values_le,
+                 f32 const* values_ri,
+                 AudioFrame const* in,
+                 AudioFrame* out,
+                 i32 num_frames);
+} // namespace scalar
+
+#if defined(HA_FX_COLLECTION_X86_KERNELS)
+namespace sse2 {
+void apply_width(f32 width,
+                 mut_f32* values_le,
+                 mut_f32* values_ri,
+                 i32 num_frames);
+void apply_contour(ContourCoeffs const& coeffs,
+                   bool is_denormal_safe,
+                   mut_f32& state_le,
+                   mut_f32& state_ri,
+                   mut_f32* values_le,
+                   mut_f32* values_ri,
+                   i32 num_frames);
+void apply_mix(f32 const* mixes,
+               mut_f32* values_le,
+               mut_f32* values_ri,
+               i32 num_frames);
+void apply_gains(f32 const* values_le,
+                 f32 const* values_ri,
+                 AudioFrame const* in,
+                 AudioFrame* out,
+                 i32 num_frames);
+} // namespace sse2
+
+namespace avx2 {
+void apply_width(f32 width,
+                 mut_f32* values_le,
+                 mut_f32* values_ri,
+                 i32 num_frames);
+void apply_contour(ContourCoeffs const& coeffs,
+                   bool is_denormal_safe,
+                   mut_f32& state_le,
+                   mut_f32& state_ri,
+                   mut_f32* values_le,
+                   mut_f32* values_ri,
+                   i32 num_frames);
+void apply_mix(f32 const* mixes,
+               mut_f32* values_le,
+               mut_f32* values_ri,
+               i32 num_frames);
+void apply_gains(f32 const* values_le,
+                 f32 const* values_ri,
+                 AudioFrame const* in,
+                 AudioFrame* out,
+                 i32 num_frames);
+} // namespace avx2
+
+namespace avx512 {
+void apply_width(f32 width,
+                 mut_f32* values_le,
+                 mut_f32* values_ri,
+                 i32 num_frames);
+void apply_contour(ContourCoeffs const& coeffs,
+                   bool is_denormal_safe,
+                   mut_f32& state_le,
+                   mut_f32& state_ri,
+                   mut_f32* values_le,
+                   mut_f32* values_ri,
+                   i32 num_frames);
+void apply_mix(f32 const* mixes,
+               mut_f32* values_le,
+               mut_f32* values_ri,
+               i32 num_frames);
+void apply_gains(f32 const* values_le,
+                 f32 const* values_ri,
+                 AudioFrame const* in,
+                 AudioFrame* out,
+                 i32 num_frames);
+} // namespace avx512
+#endif
+
+//-----------------------------------------------------------------------------
+} // namespace ha::fx_collection::detail
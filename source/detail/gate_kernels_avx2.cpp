@@ -0,0 +1,240 @@
+// Copyright(c) 2021 Hansen Audio.
+
+// Compiled with AVX2 enabled. Only use intrinsics and plain loops in here,
+// inline functions shared with other translation units could end up with
+// instructions not every CPU supports.
+
+#include "gate_kernels.h"
+#include <immintrin.h>
+
+namespace ha::fx_collection::detail::avx2 {
+
+//-----------------------------------------------------------------------------
+static constexpr i32 NUM_LANES        = 8;
+static constexpr i32 NUM_GAIN_FRAMES  = 4;
+static constexpr i32 KEEP_CHANNELS_23 = 0xCC;
+
+//-----------------------------------------------------------------------------
+void apply_width(f32 width,
+                 mut_f32* values_le,
+                 mut_f32* values_ri,
+                 i32 num_frames)
+{
+    __m256 const w = _mm256_set1_ps(width);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m256 le = _mm256_loadu_ps(values_le + i);
+        __m256 ri = _mm256_loadu_ps(values_ri + i);
+        // Operand order matches std::max(a, b), which returns a unless a < b.
+        le = _mm256_max_ps(_mm256_mul_ps(ri, w), le);
+        ri = _mm256_max_ps(_mm256_mul_ps(le, w), ri);
+        _mm256_storeu_ps(values_le + i, le);
+        _mm256_storeu_ps(values_ri + i, ri);
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        f32 le       = values_ri[i] * width;
+        values_le[i] = values_le[i] < le ? le : values_le[i];
+        f32 ri       = values_le[i] * width;
+        values_ri[i] = values_ri[i] < ri ? ri : values_ri[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+/*  The contour recursion unrolled over the lanes, see make_contour_taps. Only
+    the decay term depends on the previous register, so there is one serial
+    multiply-add per NUM_LANES frames instead of one per frame.
+ */
+struct ContourLanes
+{
+    __m256 decay;
+    __m256 taps[NUM_LANES];
+};
+
+//-----------------------------------------------------------------------------
+static ContourLanes make_contour_lanes(ContourCoeffs const& coeffs)
+{
+    alignas(32) mut_f32 decay[NUM_LANES];
+    mut_f32 taps[2 * NUM_LANES - 1];
+    make_contour_taps(coeffs, NUM_LANES, decay, taps);
+
+    ContourLanes lanes;
+    lanes.decay = _mm256_load_ps(decay);
+    for (mut_i32 j = 0; j < NUM_LANES; ++j)
+        lanes.taps[j] = _mm256_loadu_ps(taps + NUM_LANES - 1 - j);
+
+    return lanes;
+}
+
+//-----------------------------------------------------------------------------
+static __m256 process_contour_lanes(ContourLanes const& lanes,
+                                    __m256 state,
+                                    f32 const* values)
+{
+    __m256 sum = _mm256_mul_ps(lanes.taps[0], _mm256_set1_ps(values[0]));
+    for (mut_i32 j = 1; j < NUM_LANES; ++j)
+    {
+        __m256 const x = _mm256_set1_ps(values[j]);
+        sum            = _mm256_add_ps(sum, _mm256_mul_ps(lanes.taps[j], x));
+    }
+
+    return _mm256_add_ps(sum, _mm256_mul_ps(lanes.decay, state));
+}
+
+//-----------------------------------------------------------------------------
+static __m256 snap_to_zero(__m256 value)
+{
+    __m256 const magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.f), value);
+    __m256 const is_tiny   = _mm256_cmp_ps(
+        magnitude, _mm256_set1_ps(DENORMAL_THRESHOLD), _CMP_LT_OQ);
+    return _mm256_andnot_ps(is_tiny, value);
+}
+
+//-----------------------------------------------------------------------------
+void apply_contour(ContourCoeffs const& coeffs,
+                   bool is_denormal_safe,
+                   mut_f32& state_le,
+                   mut_f32& state_ri,
+                   mut_f32* values_le,
+                   mut_f32* values_ri,
+                   i32 num_frames)
+{
+    /*  Snapping to zero happens per register, lanes after a snapped one are
+        computed from the unsnapped value. The difference stays below
+        DENORMAL_THRESHOLD.
+     */
+    ContourLanes const lanes = make_contour_lanes(coeffs);
+
+    __m256 le = _mm256_set1_ps(state_le);
+    __m256 ri = _mm256_set1_ps(state_ri);
+
+    __m256i const last_lane = _mm256_set1_epi32(NUM_LANES - 1);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m256 y_le = process_contour_lanes(lanes, le, values_le + i);
+        __m256 y_ri = process_contour_lanes(lanes, ri, values_ri + i);
+        if (is_denormal_safe)
+        {
+            y_le = snap_to_zero(y_le);
+            y_ri = snap_to_zero(y_ri);
+        }
+
+        _mm256_storeu_ps(values_le + i, y_le);
+        _mm256_storeu_ps(values_ri + i, y_ri);
+        le = _mm256_permutevar8x32_ps(y_le, last_lane);
+        ri = _mm256_permutevar8x32_ps(y_ri, last_lane);
+    }
+
+    i32 num_tail = num_frames - i;
+    if (num_tail == 0)
+    {
+        state_le = _mm256_cvtss_f32(le);
+        state_ri = _mm256_cvtss_f32(ri);
+        return;
+    }
+
+    // The remaining frames run through one zero padded register.
+    alignas(32) mut_f32 tail_le[NUM_LANES] = {};
+    alignas(32) mut_f32 tail_ri[NUM_LANES] = {};
+    for (mut_i32 k = 0; k < num_tail; ++k)
+    {
+        tail_le[k] = values_le[i + k];
+        tail_ri[k] = values_ri[i + k];
+    }
+
+    __m256 y_le = process_contour_lanes(lanes, le, tail_le);
+    __m256 y_ri = process_contour_lanes(lanes, ri, tail_ri);
+    if (is_denormal_safe)
+    {
+        y_le = snap_to_zero(y_le);
+        y_ri = snap_to_zero(y_ri);
+    }
+
+    _mm256_store_ps(tail_le, y_le);
+    _mm256_store_ps(tail_ri, y_ri);
+    for (mut_i32 k = 0; k < num_tail; ++k)
+    {
+        values_le[i + k] = tail_le[k];
+        values_ri[i + k] = tail_ri[k];
+    }
+
+    state_le = tail_le[num_tail - 1];
+    state_ri = tail_ri[num_tail - 1];
+}
+
+//-----------------------------------------------------------------------------
+void apply_mix(f32 const* mixes,
+               mut_f32* values_le,
+               mut_f32* values_ri,
+               i32 num_frames)
+{
+    __m256 const one = _mm256_set1_ps(1.f);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m256 const mix  = _mm256_loadu_ps(mixes + i);
+        __m256 const base = _mm256_sub_ps(one, mix);
+        __m256 const le   = _mm256_loadu_ps(values_le + i);
+        __m256 const ri   = _mm256_loadu_ps(values_ri + i);
+        _mm256_storeu_ps(values_le + i,
+                         _mm256_add_ps(base, _mm256_mul_ps(le, mix)));
+        _mm256_storeu_ps(values_ri + i,
+                         _mm256_add_ps(base, _mm256_mul_ps(ri, mix)));
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        values_le[i] = (f32(1.) - mixes[i]) + values_le[i] * mixes[i];
+        values_ri[i] = (f32(1.) - mixes[i]) + values_ri[i] * mixes[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+void apply_gains(f32 const* values_le,
+                 f32 const* values_ri,
+                 AudioFrame const* in,
+                 AudioFrame* out,
+                 i32 num_frames)
+{
+    // Two frames per register. Channels 2 and 3 of out are left untouched.
+    auto const* src = reinterpret_cast<float const*>(in);
+    auto* dst       = reinterpret_cast<float*>(out);
+
+    __m256i const spread = _mm256_setr_epi32(0, 1, 0, 1, 2, 3, 2, 3);
+
+    mut_i32 i = 0;
+    for (; i + NUM_GAIN_FRAMES <= num_frames; i += NUM_GAIN_FRAMES)
+    {
+        __m128 const le       = _mm_loadu_ps(values_le + i);
+        __m128 const ri       = _mm_loadu_ps(values_ri + i);
+        __m256 const gains_01 = _mm256_permutevar8x32_ps(
+            _mm256_castps128_ps256(_mm_unpacklo_ps(le, ri)), spread);
+        __m256 const gains_23 = _mm256_permutevar8x32_ps(
+            _mm256_castps128_ps256(_mm_unpackhi_ps(le, ri)), spread);
+
+        float const* s = src + i * NUM_CHANNELS;
+        float* d       = dst + i * NUM_CHANNELS;
+
+        __m256 const p_01 = _mm256_mul_ps(_mm256_loadu_ps(s), gains_01);
+        __m256 const p_23 = _mm256_mul_ps(_mm256_loadu_ps(s + 8), gains_23);
+        _mm256_storeu_ps(
+            d, _mm256_blend_ps(p_01, _mm256_loadu_ps(d), KEEP_CHANNELS_23));
+        _mm256_storeu_ps(d + 8, _mm256_blend_ps(p_23, _mm256_loadu_ps(d + 8),
+                                                KEEP_CHANNELS_23));
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        dst[i * NUM_CHANNELS]     = src[i * NUM_CHANNELS] * values_le[i];
+        dst[i * NUM_CHANNELS + 1] = src[i * NUM_CHANNELS + 1] * values_ri[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+} // namespace ha::fx_collection::detail::avx2
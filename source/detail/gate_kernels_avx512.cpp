@@ -0,0 +1,242 @@
+// Copyright(c) 2021 Hansen Audio.
+
+// Compiled with AVX-512F enabled. Only use intrinsics and plain loops in here,
+// inline functions shared with other translation units could end up with
+// instructions not every CPU supports.
+
+#include "gate_kernels.h"
+
+// GCC 12 warns about _mm512_undefined_ps() inside its own intrinsics, which
+// leave lanes undefined on purpose (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+
+namespace ha::fx_collection::detail::avx512 {
+
+//-----------------------------------------------------------------------------
+static constexpr i32 NUM_LANES         = 16;
+static constexpr i32 NUM_GAIN_FRAMES   = 4;
+static constexpr __mmask16 CHANNELS_01 = 0x3333;
+
+//-----------------------------------------------------------------------------
+void apply_width(f32 width,
+                 mut_f32* values_le,
+                 mut_f32* values_ri,
+                 i32 num_frames)
+{
+    __m512 const w = _mm512_set1_ps(width);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m512 le = _mm512_loadu_ps(values_le + i);
+        __m512 ri = _mm512_loadu_ps(values_ri + i);
+        // Operand order matches std::max(a, b), which returns a unless a < b.
+        le = _mm512_max_ps(_mm512_mul_ps(ri, w), le);
+        ri = _mm512_max_ps(_mm512_mul_ps(le, w), ri);
+        _mm512_storeu_ps(values_le + i, le);
+        _mm512_storeu_ps(values_ri + i, ri);
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        f32 le       = values_ri[i] * width;
+        values_le[i] = values_le[i] < le ? le : values_le[i];
+        f32 ri       = values_le[i] * width;
+        values_ri[i] = values_ri[i] < ri ? ri : values_ri[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+/*  The contour recursion unrolled over the lanes, see make_contour_taps. Only
+    the decay term depends on the previous register, so there is one serial
+    multiply-add per NUM_LANES frames instead of one per frame.
+ */
+struct ContourLanes
+{
+    __m512 decay;
+    __m512 taps[NUM_LANES];
+};
+
+//-----------------------------------------------------------------------------
+static ContourLanes make_contour_lanes(ContourCoeffs const& coeffs)
+{
+    alignas(64) mut_f32 decay[NUM_LANES];
+    mut_f32 taps[2 * NUM_LANES - 1];
+    make_contour_taps(coeffs, NUM_LANES, decay, taps);
+
+    ContourLanes lanes;
+    lanes.decay = _mm512_load_ps(decay);
+    for (mut_i32 j = 0; j < NUM_LANES; ++j)
+        lanes.taps[j] = _mm512_loadu_ps(taps + NUM_LANES - 1 - j);
+
+    return lanes;
+}
+
+//-----------------------------------------------------------------------------
+static __m512 process_contour_lanes(ContourLanes const& lanes,
+                                    __m512 state,
+                                    f32 const* values)
+{
+    __m512 sum = _mm512_mul_ps(lanes.taps[0], _mm512_set1_ps(values[0]));
+    for (mut_i32 j = 1; j < NUM_LANES; ++j)
+    {
+        __m512 const x = _mm512_set1_ps(values[j]);
+        sum            = _mm512_add_ps(sum, _mm512_mul_ps(lanes.taps[j], x));
+    }
+
+    return _mm512_add_ps(sum, _mm512_mul_ps(lanes.decay, state));
+}
+
+//-----------------------------------------------------------------------------
+static __m512 snap_to_zero(__m512 value)
+{
+    __mmask16 const is_tiny = _mm512_cmp_ps_mask(
+        _mm512_abs_ps(value), _mm512_set1_ps(DENORMAL_THRESHOLD), _CMP_LT_OQ);
+    return _mm512_mask_mov_ps(value, is_tiny, _mm512_setzero_ps());
+}
+
+//-----------------------------------------------------------------------------
+void apply_contour(ContourCoeffs const& coeffs,
+                   bool is_denormal_safe,
+                   mut_f32& state_le,
+                   mut_f32& state_ri,
+                   mut_f32* values_le,
+                   mut_f32* values_ri,
+                   i32 num_frames)
+{
+    /*  Snapping to zero happens per register, lanes after a snapped one are
+        computed from the unsnapped value. The difference stays below
+        DENORMAL_THRESHOLD.
+     */
+    ContourLanes const lanes = make_contour_lanes(coeffs);
+
+    __m512 le = _mm512_set1_ps(state_le);
+    __m512 ri = _mm512_set1_ps(state_ri);
+
+    __m512i const last_lane = _mm512_set1_epi32(NUM_LANES - 1);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m512 y_le = process_contour_lanes(lanes, le, values_le + i);
+        __m512 y_ri = process_contour_lanes(lanes, ri, values_ri + i);
+        if (is_denormal_safe)
+        {
+            y_le = snap_to_zero(y_le);
+            y_ri = snap_to_zero(y_ri);
+        }
+
+        _mm512_storeu_ps(values_le + i, y_le);
+        _mm512_storeu_ps(values_ri + i, y_ri);
+        le = _mm512_permutexvar_ps(last_lane, y_le);
+        ri = _mm512_permutexvar_ps(last_lane, y_ri);
+    }
+
+    i32 num_tail = num_frames - i;
+    if (num_tail == 0)
+    {
+        state_le = _mm512_cvtss_f32(le);
+        state_ri = _mm512_cvtss_f32(ri);
+        return;
+    }
+
+    // The remaining frames run through one zero padded register.
+    alignas(64) mut_f32 tail_le[NUM_LANES] = {};
+    alignas(64) mut_f32 tail_ri[NUM_LANES] = {};
+    for (mut_i32 k = 0; k < num_tail; ++k)
+    {
+        tail_le[k] = values_le[i + k];
+        tail_ri[k] = values_ri[i + k];
+    }
+
+    __m512 y_le = process_contour_lanes(lanes, le, tail_le);
+    __m512 y_ri = process_contour_lanes(lanes, ri, tail_ri);
+    if (is_denormal_safe)
+    {
+        y_le = snap_to_zero(y_le);
+        y_ri = snap_to_zero(y_ri);
+    }
+
+    _mm512_store_ps(tail_le, y_le);
+    _mm512_store_ps(tail_ri, y_ri);
+    for (mut_i32 k = 0; k < num_tail; ++k)
+    {
+        values_le[i + k] = tail_le[k];
+        values_ri[i + k] = tail_ri[k];
+    }
+
+    state_le = tail_le[num_tail - 1];
+    state_ri = tail_ri[num_tail - 1];
+}
+
+//-----------------------------------------------------------------------------
+void apply_mix(f32 const* mixes,
+               mut_f32* values_le,
+               mut_f32* values_ri,
+               i32 num_frames)
+{
+    __m512 const one = _mm512_set1_ps(1.f);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m512 const mix  = _mm512_loadu_ps(mixes + i);
+        __m512 const base = _mm512_sub_ps(one, mix);
+        __m512 const le   = _mm512_loadu_ps(values_le + i);
+        __m512 const ri   = _mm512_loadu_ps(values_ri + i);
+        _mm512_storeu_ps(values_le + i,
+                         _mm512_add_ps(base, _mm512_mul_ps(le, mix)));
+        _mm512_storeu_ps(values_ri + i,
+                         _mm512_add_ps(base, _mm512_mul_ps(ri, mix)));
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        values_le[i] = (f32(1.) - mixes[i]) + values_le[i] * mixes[i];
+        values_ri[i] = (f32(1.) - mixes[i]) + values_ri[i] * mixes[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+void apply_gains(f32 const* values_le,
+                 f32 const* values_ri,
+                 AudioFrame const* in,
+                 AudioFrame* out,
+                 i32 num_frames)
+{
+    // Four frames per register. Channels 2 and 3 of out are left untouched.
+    auto const* src = reinterpret_cast<float const*>(in);
+    auto* dst       = reinterpret_cast<float*>(out);
+
+    __m512i const spread =
+        _mm512_setr_epi32(0, 1, 0, 1, 2, 3, 2, 3, 4, 5, 4, 5, 6, 7, 6, 7);
+
+    mut_i32 i = 0;
+    for (; i + NUM_GAIN_FRAMES <= num_frames; i += NUM_GAIN_FRAMES)
+    {
+        __m128 const le          = _mm_loadu_ps(values_le + i);
+        __m128 const ri          = _mm_loadu_ps(values_ri + i);
+        __m256 const interleaved = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(_mm_unpacklo_ps(le, ri)),
+            _mm_unpackhi_ps(le, ri), 1);
+        __m512 const gains = _mm512_permutexvar_ps(
+            spread, _mm512_zextps256_ps512(interleaved));
+
+        float const* s = src + i * NUM_CHANNELS;
+        float* d       = dst + i * NUM_CHANNELS;
+        _mm512_storeu_ps(d, _mm512_mask_mul_ps(_mm512_loadu_ps(d), CHANNELS_01,
+                                               _mm512_loadu_ps(s), gains));
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        dst[i * NUM_CHANNELS]     = src[i * NUM_CHANNELS] * values_le[i];
+        dst[i * NUM_CHANNELS + 1] = src[i * NUM_CHANNELS + 1] * values_ri[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+} // namespace ha::fx_collection::detail::avx512
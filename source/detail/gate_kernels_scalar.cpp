@@ -0,0 +1,119 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "gate_kernels.h"
+#include "ha/dsp_tool_box/filtering/one_pole.h"
+#include <algorithm>
+
+namespace ha::fx_collection::detail {
+
+//-----------------------------------------------------------------------------
+void flush_denormal(dtb::filtering::OnePole& filter, mut_f32& value)
+{
+    using OnePoleImpl = dtb::filtering::OnePoleImpl;
+
+    if (value < DENORMAL_THRESHOLD && value > -DENORMAL_THRESHOLD)
+    {
+        value = f32(0.);
+        OnePoleImpl::reset(filter, value);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void make_contour_taps(ContourCoeffs const& coeffs,
+                       i32 num_lanes,
+                       mut_f32* decay,
+                       mut_f32* taps)
+{
+    auto const snap = [](f32 value) {
+        return value < DENORMAL_THRESHOLD ? f32(0.) : value;
+    };
+
+    for (mut_i32 k = 0; k < num_lanes - 1; ++k)
+        taps[k] = f32(0.);
+
+    // The powers are accumulated in double and rounded to float once, so
+    // their error does not grow with the lane count of the ISA.
+    mut_f64 power = 1.;
+    for (mut_i32 k = 0; k < num_lanes; ++k)
+    {
+        taps[num_lanes - 1 + k] = snap(f32(coeffs.gain * power));
+        power *= coeffs.pole;
+        decay[k] = snap(f32(power));
+    }
+}
+
+namespace scalar {
+
+//-----------------------------------------------------------------------------
+void apply_width(f32 width,
+                 mut_f32* values_le,
+                 mut_f32* values_ri,
+                 i32 num_frames)
+{
+    for (mut_i32 i = 0; i < num_frames; ++i)
+    {
+        values_le[i] = std::max(values_le[i], values_ri[i] * width);
+        values_ri[i] = std::max(values_ri[i], values_le[i] * width);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void apply_contour(ContourCoeffs const& coeffs,
+                   bool is_denormal_safe,
+                   mut_f32& state_le,
+                   mut_f32& state_ri,
+                   mut_f32* values_le,
+                   mut_f32* values_ri,
+                   i32 num_frames)
+{
+    // Same operations as OnePoleImpl::process.
+    for (mut_i32 i = 0; i < num_frames; ++i)
+    {
+        state_le = values_le[i] * coeffs.gain + state_le * coeffs.pole;
+        state_ri = values_ri[i] * coeffs.gain + state_ri * coeffs.pole;
+
+        if (is_denormal_safe)
+        {
+            if (state_le < DENORMAL_THRESHOLD && state_le > -DENORMAL_THRESHOLD)
+                state_le = f32(0.);
+            if (state_ri < DENORMAL_THRESHOLD && state_ri > -DENORMAL_THRESHOLD)
+                state_ri = f32(0.);
+        }
+
+        values_le[i] = state_le;
+        values_ri[i] = state_ri;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void apply_mix(f32 const* mixes,
+               mut_f32* values_le,
+               mut_f32* values_ri,
+               i32 num_frames)
+{
+    static constexpr f32 MIX_MAX = f32(1.);
+
+    for (mut_i32 i = 0; i < num_frames; ++i)
+    {
+        values_le[i] = (MIX_MAX - mixes[i]) + values_le[i] * mixes[i];
+        values_ri[i] = (MIX_MAX - mixes[i]) + values_ri[i] * mixes[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+void apply_gains(f32 const* values_le,
+                 f32 const* values_ri,
+                 AudioFrame const* in,
+                 AudioFrame* out,
+                 i32 num_frames)
+{
+    for (mut_i32 i = 0; i < num_frames; ++i)
+    {
+        out[i].data[0] = in[i].data[0] * values_le[i];
+        out[i].data[1] = in[i].data[1] * values_ri[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+} // namespace scalar
+} // namespace ha::fx_collection::detail
@@ -0,0 +1,231 @@
+// Copyright(c) 2021 Hansen Audio.
+
+// Compiled with SSE2 enabled. Only use intrinsics and plain loops in here,
+// inline functions shared with other translation units could end up with
+// instructions not every CPU supports.
+
+#include "gate_kernels.h"
+#include <emmintrin.h>
+
+namespace ha::fx_collection::detail::sse2 {
+
+//-----------------------------------------------------------------------------
+static constexpr i32 NUM_LANES = 4;
+
+//-----------------------------------------------------------------------------
+void apply_width(f32 width,
+                 mut_f32* values_le,
+                 mut_f32* values_ri,
+                 i32 num_frames)
+{
+    __m128 const w = _mm_set1_ps(width);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m128 le = _mm_loadu_ps(values_le + i);
+        __m128 ri = _mm_loadu_ps(values_ri + i);
+        // Operand order matches std::max(a, b), which returns a unless a < b.
+        le = _mm_max_ps(_mm_mul_ps(ri, w), le);
+        ri = _mm_max_ps(_mm_mul_ps(le, w), ri);
+        _mm_storeu_ps(values_le + i, le);
+        _mm_storeu_ps(values_ri + i, ri);
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        f32 le       = values_ri[i] * width;
+        values_le[i] = values_le[i] < le ? le : values_le[i];
+        f32 ri       = values_le[i] * width;
+        values_ri[i] = values_ri[i] < ri ? ri : values_ri[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+/*  The contour recursion unrolled over the lanes, see make_contour_taps. Only
+    the decay term depends on the previous register, so there is one serial
+    multiply-add per NUM_LANES frames instead of one per frame.
+ */
+struct ContourLanes
+{
+    __m128 decay;
+    __m128 taps[NUM_LANES];
+};
+
+//-----------------------------------------------------------------------------
+static ContourLanes make_contour_lanes(ContourCoeffs const& coeffs)
+{
+    alignas(16) mut_f32 decay[NUM_LANES];
+    mut_f32 taps[2 * NUM_LANES - 1];
+    make_contour_taps(coeffs, NUM_LANES, decay, taps);
+
+    ContourLanes lanes;
+    lanes.decay = _mm_load_ps(decay);
+    for (mut_i32 j = 0; j < NUM_LANES; ++j)
+        lanes.taps[j] = _mm_loadu_ps(taps + NUM_LANES - 1 - j);
+
+    return lanes;
+}
+
+//-----------------------------------------------------------------------------
+static __m128 process_contour_lanes(ContourLanes const& lanes,
+                                    __m128 state,
+                                    f32 const* values)
+{
+    __m128 sum = _mm_mul_ps(lanes.taps[0], _mm_set1_ps(values[0]));
+    for (mut_i32 j = 1; j < NUM_LANES; ++j)
+    {
+        __m128 const x = _mm_set1_ps(values[j]);
+        sum            = _mm_add_ps(sum, _mm_mul_ps(lanes.taps[j], x));
+    }
+
+    return _mm_add_ps(sum, _mm_mul_ps(lanes.decay, state));
+}
+
+//-----------------------------------------------------------------------------
+static __m128 snap_to_zero(__m128 value)
+{
+    __m128 const magnitude = _mm_andnot_ps(_mm_set1_ps(-0.f), value);
+    __m128 const is_tiny =
+        _mm_cmplt_ps(magnitude, _mm_set1_ps(DENORMAL_THRESHOLD));
+    return _mm_andnot_ps(is_tiny, value);
+}
+
+//-----------------------------------------------------------------------------
+void apply_contour(ContourCoeffs const& coeffs,
+                   bool is_denormal_safe,
+                   mut_f32& state_le,
+                   mut_f32& state_ri,
+                   mut_f32* values_le,
+                   mut_f32* values_ri,
+                   i32 num_frames)
+{
+    /*  Snapping to zero happens per register, lanes after a snapped one are
+        computed from the unsnapped value. The difference stays below
+        DENORMAL_THRESHOLD.
+     */
+    ContourLanes const lanes = make_contour_lanes(coeffs);
+
+    __m128 le = _mm_set1_ps(state_le);
+    __m128 ri = _mm_set1_ps(state_ri);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m128 y_le = process_contour_lanes(lanes, le, values_le + i);
+        __m128 y_ri = process_contour_lanes(lanes, ri, values_ri + i);
+        if (is_denormal_safe)
+        {
+            y_le = snap_to_zero(y_le);
+            y_ri = snap_to_zero(y_ri);
+        }
+
+        _mm_storeu_ps(values_le + i, y_le);
+        _mm_storeu_ps(values_ri + i, y_ri);
+        le = _mm_shuffle_ps(y_le, y_le, _MM_SHUFFLE(3, 3, 3, 3));
+        ri = _mm_shuffle_ps(y_ri, y_ri, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    i32 num_tail = num_frames - i;
+    if (num_tail == 0)
+    {
+        state_le = _mm_cvtss_f32(le);
+        state_ri = _mm_cvtss_f32(ri);
+        return;
+    }
+
+    // The remaining frames run through one zero padded register.
+    alignas(16) mut_f32 tail_le[NUM_LANES] = {};
+    alignas(16) mut_f32 tail_ri[NUM_LANES] = {};
+    for (mut_i32 k = 0; k < num_tail; ++k)
+    {
+        tail_le[k] = values_le[i + k];
+        tail_ri[k] = values_ri[i + k];
+    }
+
+    __m128 y_le = process_contour_lanes(lanes, le, tail_le);
+    __m128 y_ri = process_contour_lanes(lanes, ri, tail_ri);
+    if (is_denormal_safe)
+    {
+        y_le = snap_to_zero(y_le);
+        y_ri = snap_to_zero(y_ri);
+    }
+
+    _mm_store_ps(tail_le, y_le);
+    _mm_store_ps(tail_ri, y_ri);
+    for (mut_i32 k = 0; k < num_tail; ++k)
+    {
+        values_le[i + k] = tail_le[k];
+        values_ri[i + k] = tail_ri[k];
+    }
+
+    state_le = tail_le[num_tail - 1];
+    state_ri = tail_ri[num_tail - 1];
+}
+
+//-----------------------------------------------------------------------------
+void apply_mix(f32 const* mixes,
+               mut_f32* values_le,
+               mut_f32* values_ri,
+               i32 num_frames)
+{
+    __m128 const one = _mm_set1_ps(1.f);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m128 const mix  = _mm_loadu_ps(mixes + i);
+        __m128 const base = _mm_sub_ps(one, mix);
+        __m128 const le   = _mm_loadu_ps(values_le + i);
+        __m128 const ri   = _mm_loadu_ps(values_ri + i);
+        _mm_storeu_ps(values_le + i, _mm_add_ps(base, _mm_mul_ps(le, mix)));
+        _mm_storeu_ps(values_ri + i, _mm_add_ps(base, _mm_mul_ps(ri, mix)));
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        values_le[i] = (f32(1.) - mixes[i]) + values_le[i] * mixes[i];
+        values_ri[i] = (f32(1.) - mixes[i]) + values_ri[i] * mixes[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+void apply_gains(f32 const* values_le,
+                 f32 const* values_ri,
+                 AudioFrame const* in,
+                 AudioFrame* out,
+                 i32 num_frames)
+{
+    // One frame is one register. Channels 2 and 3 of out are left untouched.
+    auto const* src = reinterpret_cast<float const*>(in);
+    auto* dst       = reinterpret_cast<float*>(out);
+
+    mut_i32 i = 0;
+    for (; i + NUM_LANES <= num_frames; i += NUM_LANES)
+    {
+        __m128 const le = _mm_loadu_ps(values_le + i);
+        __m128 const ri = _mm_loadu_ps(values_ri + i);
+        __m128 const lo = _mm_unpacklo_ps(le, ri);
+        __m128 const hi = _mm_unpackhi_ps(le, ri);
+
+        __m128 const gains[NUM_LANES] = {lo, _mm_movehl_ps(lo, lo), hi,
+                                         _mm_movehl_ps(hi, hi)};
+        for (mut_i32 k = 0; k < NUM_LANES; ++k)
+        {
+            float const* s = src + (i + k) * NUM_CHANNELS;
+            float* d       = dst + (i + k) * NUM_CHANNELS;
+            __m128 const p = _mm_mul_ps(_mm_load_ps(s), gains[k]);
+            _mm_store_ps(d, _mm_shuffle_ps(p, _mm_load_ps(d),
+                                           _MM_SHUFFLE(3, 2, 1, 0)));
+        }
+    }
+
+    for (; i < num_frames; ++i)
+    {
+        dst[i * NUM_CHANNELS]     = src[i * NUM_CHANNELS] * values_le[i];
+        dst[i * NUM_CHANNELS + 1] = src[i * NUM_CHANNELS + 1] * values_ri[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+} // namespace ha::fx_collection::detail::sse2
@@ -0,0 +1,44 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/gain_pan.h"
+#include <cmath>
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+//	GainPanImpl
+//------------------------------------------------------------------------
+GainPan GainPanImpl::create()
+{
+    GainPan gain_pan;
+    update_gains(gain_pan);
+
+    return gain_pan;
+}
+
+//------------------------------------------------------------------------
+void GainPanImpl::set_gain(GainPan& gain_pan, f32 value)
+{
+    gain_pan.gain = value;
+    update_gains(gain_pan);
+}
+
+//------------------------------------------------------------------------
+void GainPanImpl::set_pan(GainPan& gain_pan, f32 value_normalised)
+{
+    gain_pan.pan = value_normalised;
+    update_gains(gain_pan);
+}
+
+//------------------------------------------------------------------------
+void GainPanImpl::update_gains(GainPan& gain_pan)
+{
+    static constexpr f32 HALF_PI = f32(1.57079632679489661923);
+
+    f32 angle        = gain_pan.pan * HALF_PI;
+    gain_pan.gain_le = gain_pan.gain * std::cos(angle);
+    gain_pan.gain_ri = gain_pan.gain * std::sin(angle);
+}
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
@@ -0,0 +1,174 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/sample_timeline.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace ha::fx_collection {
+
+//------------------------------------------------------------------------
+struct MulDivResult
+{
+    mut_u64 quotient  = 0;
+    mut_u64 remainder = 0;
+};
+
+//------------------------------------------------------------------------
+/*  Computes (a * b) / c with a 128 bit intermediate product. Only used when
+    seeking or changing the step length, so a portable bitwise long division
+    is fast enough. The quotient must fit into 64 bits.
+ */
+static MulDivResult mul_div(u64 a, u64 b, u64 c)
+{
+    constexpr u64 LO_MASK = 0xFFFFFFFF;
+
+    u64 a_lo = a & LO_MASK;
+    u64 a_hi = a >> 32;
+    u64 b_lo = b & LO_MASK;
+    u64 b_hi = b >> 32;
+
+    u64 p0  = a_lo * b_lo;
+    u64 p1  = a_lo * b_hi;
+    u64 p2  = a_hi * b_lo;
+    u64 p3  = a_hi * b_hi;
+    u64 mid = (p0 >> 32) + (p1 & LO_MASK) + (p2 & LO_MASK);
+
+    u64 lo = (mid << 32) | (p0 & LO_MASK);
+    u64 hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+
+    MulDivResult result;
+    for (mut_i32 bit = 127; bit >= 0; --bit)
+    {
+        u64 next = bit >= 64 ? (hi >> (bit - 64)) & 1 : (lo >> bit) & 1;
+
+        // c is far below 2^63 here, so the shift never overflows.
+        result.remainder = (result.remainder << 1) | next;
+        result.quotient <<= 1;
+        if (result.remainder >= c)
+        {
+            result.remainder -= c;
+            result.quotient |= 1;
+        }
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------
+//	SampleTimelineImpl
+//------------------------------------------------------------------------
+SampleTimeline SampleTimelineImpl::create()
+{
+    SampleTimeline timeline;
+    update_step_len(timeline);
+
+    return timeline;
+}
+
+//------------------------------------------------------------------------
+u64 SampleTimelineImpl::advance(SampleTimeline& timeline, u32 num_samples)
+{
+    timeline.sample_pos += num_samples;
+    timeline.step_remainder += u64(num_samples) * timeline.step_len_den;
+    if (timeline.step_remainder < timeline.step_len_num)
+        return 0;
+
+    u64 num_steps = timeline.step_remainder / timeline.step_len_num;
+    timeline.step_remainder %= timeline.step_len_num;
+    timeline.step_index += num_steps;
+
+    return num_steps;
+}
+
+//------------------------------------------------------------------------
+u64 SampleTimelineImpl::samples_until_next_step(SampleTimeline const& timeline)
+{
+    u64 left = timeline.step_len_num - timeline.step_remainder;
+
+    return (left + timeline.step_len_den - 1) / timeline.step_len_den;
+}
+
+//------------------------------------------------------------------------
+f64 SampleTimelineImpl::get_step_phase(SampleTimeline const& timeline)
+{
+    return f64(timeline.step_remainder) / f64(timeline.step_len_num);
+}
+
+//------------------------------------------------------------------------
+void SampleTimelineImpl::set_sample_pos(SampleTimeline& timeline, u64 value)
+{
+    auto const result =
+        mul_div(value, timeline.step_len_den, timeline.step_len_num);
+
+    timeline.sample_pos     = value;
+    timeline.step_index     = result.quotient;
+    timeline.step_remainder = result.remainder;
+}
+
+//------------------------------------------------------------------------
+void SampleTimelineImpl::set_project_time_music(SampleTimeline& timeline,
+                                                f64 value)
+{
+    constexpr f64 SECONDS_PER_MINUTE = 60.;
+
+    f64 tempo   = f64(timeline.tempo) / SampleTimeline::TEMPO_SCALE;
+    f64 samples = value * SECONDS_PER_MINUTE / tempo * timeline.sample_rate;
+    set_sample_pos(timeline, u64(std::llround(std::max(samples, 0.))));
+}
+
+//------------------------------------------------------------------------
+void SampleTimelineImpl::restart_step(SampleTimeline& timeline)
+{
+    timeline.step_remainder = 0;
+}
+
+//------------------------------------------------------------------------
+void SampleTimelineImpl::set_tempo(SampleTimeline& timeline, f64 value)
+{
+    timeline.tempo = std::max(
+        u64(std::llround(value * SampleTimeline::TEMPO_SCALE)), u64(1));
+    update_step_len(timeline);
+}
+
+//------------------------------------------------------------------------
+void SampleTimelineImpl::set_sample_rate(SampleTimeline& timeline, f64 value)
+{
+    timeline.sample_rate = std::max(u64(std::llround(value)), u64(1));
+    update_step_len(timeline);
+}
+
+//------------------------------------------------------------------------
+void SampleTimelineImpl::set_note_len(SampleTimeline& timeline,
+                                      f64 value_note_len)
+{
+    timeline.note_ticks = std::max(
+        u64(std::llround(value_note_len * SampleTimeline::NOTE_TICKS)),
+        u64(1));
+    update_step_len(timeline);
+}
+
+//------------------------------------------------------------------------
+void SampleTimelineImpl::update_step_len(SampleTimeline& timeline)
+{
+    /*  samples per step = note_len * 240 / tempo * sample_rate
+                         = (note_ticks / NOTE_TICKS) * 240 * sample_rate
+                           / (tempo / TEMPO_SCALE)
+     */
+    mut_u64 num = timeline.note_ticks * SampleTimeline::WHOLE_NOTE_SECS *
+                  SampleTimeline::TEMPO_SCALE * timeline.sample_rate;
+    mut_u64 den = SampleTimeline::NOTE_TICKS * timeline.tempo;
+
+    u64 divisor = std::gcd(num, den);
+    num /= divisor;
+    den /= divisor;
+
+    // Keep the phase of the current step.
+    timeline.step_remainder =
+        mul_div(timeline.step_remainder, num, timeline.step_len_num).quotient;
+    timeline.step_len_num = num;
+    timeline.step_len_den = den;
+}
+
+//------------------------------------------------------------------------
+} // namespace ha::fx_collection
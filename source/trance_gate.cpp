@@ -1,7 +1,9 @@
 // Copyright(c) 2016 René Hansen.
 
 #include "ha/fx_collection/trance_gate.h"
+#include "detail/gate_kernels.h"
 #include "detail/shuffle_note.h"
+#include "ha/fx_collection/denormals.h"
 #include <algorithm>
 
 namespace ha::fx_collection {
@@ -9,26 +11,15 @@ namespace ha::fx_collection {
 //------------------------------------------------------------------------
 static constexpr i32 ONE_SAMPLE = 1;
 
+// Number of frames the block processing hands to the kernels at once.
+static constexpr i32 KERNEL_BLOCK_SIZE = 64;
+
 //------------------------------------------------------------------------
 static void
 apply_width(TranceGate const& trance_gate, mut_f32& value_le, mut_f32& value_ri)
 {
-    value_le = std::max(value_le, value_ri * trance_gate.width);
-    value_ri = std::max(value_ri, value_le * trance_gate.width);
-}
-
-//------------------------------------------------------------------------
-static void apply_mix(mut_f32& value, f32 mix)
-{
-    static constexpr f32 MIX_MAX = f32(1.);
-    value                        = (MIX_MAX - mix) + value * mix;
-}
-
-//------------------------------------------------------------------------
-static void apply_mix(f32 mix, mut_f32& value_le, mut_f32& value_ri)
-{
-    apply_mix(value_le, mix);
-    apply_mix(value_ri, mix);
+    detail::scalar::apply_width(trance_gate.width, &value_le, &value_ri,
+                                ONE_SAMPLE);
 }
 
 //------------------------------------------------------------------------
@@ -42,6 +33,32 @@ apply_contour(TranceGate& trance_gate, mut_f32& value_le, mut_f32& value_ri)
         OnePoleImpl::process(contour_filters.at(TranceGate::L), value_le);
     value_ri =
         OnePoleImpl::process(contour_filters.at(TranceGate::R), value_ri);
+
+    if (trance_gate.is_denormal_safe)
+    {
+        detail::flush_denormal(contour_filters.at(TranceGate::L), value_le);
+        detail::flush_denormal(contour_filters.at(TranceGate::R), value_ri);
+    }
+}
+
+//------------------------------------------------------------------------
+/*  The contour filters are one pole lowpasses, y = gain * x + pole * y[-1].
+    The coefficients are read back through the filter's interface, so the
+    contour kernels can run the recursion on their own.
+ */
+static detail::ContourCoeffs
+get_contour_coeffs(dtb::filtering::OnePole const& filter)
+{
+    using OnePoleImpl = dtb::filtering::OnePoleImpl;
+
+    auto probe = filter;
+    detail::ContourCoeffs coeffs;
+    OnePoleImpl::reset(probe, f32(0.));
+    coeffs.gain = OnePoleImpl::process(probe, f32(1.));
+    OnePoleImpl::reset(probe, f32(1.));
+    coeffs.pole = OnePoleImpl::process(probe, f32(0.));
+
+    return coeffs;
 }
 
 //------------------------------------------------------------------------
@@ -57,7 +74,7 @@ static void
 apply_mix(TranceGate& trance_gate, mut_f32& value_le, mut_f32& value_ri)
 {
     f32 tmp_mix = compute_mix(trance_gate);
-    apply_mix(tmp_mix, value_le, value_ri);
+    detail::scalar::apply_mix(&tmp_mix, &value_le, &value_ri, ONE_SAMPLE);
 }
 
 //------------------------------------------------------------------------
@@ -71,14 +88,20 @@ static void apply_gate_delay(mut_f32& value_le,
     value_ri *= factor;
 }
 
+//------------------------------------------------------------------------
+static f32 compute_shuffle_delay(TranceGate const& trance_gate)
+{
+    // TODO: Is this a good value for a MAX_DELAY?
+    constexpr f32 MAX_DELAY = f32(3. / 4.);
+    return trance_gate.shuffle * MAX_DELAY;
+}
+
 //------------------------------------------------------------------------
 static void apply_shuffle(TranceGate const& trance_gate,
                           mut_f32& value_le,
                           mut_f32& value_ri)
 {
-    // TODO: Is this a good value for a MAX_DELAY?
-    constexpr f32 MAX_DELAY = f32(3. / 4.);
-    f32 delay               = trance_gate.shuffle * MAX_DELAY;
+    f32 delay = compute_shuffle_delay(trance_gate);
 
     if (trance_gate.step_val.is_shuffle)
         apply_gate_delay(value_le, value_ri, trance_gate.step_phase_val, delay);
@@ -111,6 +134,23 @@ static void operator++(TranceGate::Step& s)
         s.pos = 0;
 }
 
+//------------------------------------------------------------------------
+/*  After a seek, the step position and phase follow the timeline. The float
+    phase timing keeps its own step position.
+ */
+static void sync_step(TranceGate& trance_gate)
+{
+    if (!trance_gate.is_sample_accurate)
+        return;
+
+    auto const& timeline = trance_gate.step_timeline;
+    auto& step           = trance_gate.step_val;
+    step.pos             = i32(timeline.step_index % u64(step.count));
+    set_shuffle(step, trance_gate.step_phase.note_len);
+    trance_gate.step_phase_val =
+        f32(SampleTimelineImpl::get_step_phase(timeline));
+}
+
 //------------------------------------------------------------------------
 //	TranceGateImpl
 //------------------------------------------------------------------------
@@ -138,6 +178,9 @@ TranceGate TranceGateImpl::create()
     PhaseImpl::set_sync_mode(trance_gate.step_phase,
                              Phase::SyncMode::ProjectSync);
 
+    trance_gate.step_timeline = SampleTimelineImpl::create();
+    SampleTimelineImpl::set_note_len(trance_gate.step_timeline, INIT_NOTE_LEN);
+
     constexpr f32 TEMPO_BPM = f32(120.);
     set_tempo(trance_gate, TEMPO_BPM);
 
@@ -159,6 +202,7 @@ void TranceGateImpl::trigger(TranceGate& trance_gate,
     trance_gate.fade_in_phase_val = f32(0.);
     trance_gate.step_phase_val    = f32(0.);
     trance_gate.step_val.pos      = 0;
+    SampleTimelineImpl::restart_step(trance_gate.step_timeline);
 
     /*	Do not reset filters in trigger. Because there can still be a voice
         in release playing back. Dann bricht auf einmal Audio weg wenn wir
@@ -212,11 +256,12 @@ void TranceGateImpl::process(TranceGate& trance_gate,
 
     // When delay is active and delay_phase has not yet overflown, just pass
     // through.
-    bool const is_overflow = PhaseImpl::advance_one_shot(
-        trance_gate.delay_phase, trance_gate.delay_phase_val, ONE_SAMPLE);
-    if (trance_gate.is_delay_active && !is_overflow)
+    if (trance_gate.is_delay_active &&
+        !PhaseImpl::advance_one_shot(trance_gate.delay_phase,
+                                     trance_gate.delay_phase_val, ONE_SAMPLE))
     {
-        out = in;
+        trance_gate.gate_gains = {f32(1.), f32(1.)};
+        out                    = in;
         return;
     }
 
@@ -226,6 +271,7 @@ void TranceGateImpl::process(TranceGate& trance_gate,
     mut_f32 value_ri = trance_gate.channel_steps[trance_gate.ch][pos];
 
     apply_trance_gate_fx(trance_gate, value_le, value_ri);
+    trance_gate.gate_gains = {value_le, value_ri};
 
     out.data[TranceGate::L] = in.data[TranceGate::L] * value_le;
     out.data[TranceGate::R] = in.data[TranceGate::R] * value_ri;
@@ -233,17 +279,253 @@ void TranceGateImpl::process(TranceGate& trance_gate,
     update_phases(trance_gate);
 }
 
+//------------------------------------------------------------------------
+void TranceGateImpl::process_block(TranceGate& trance_gate,
+                                   AudioFrame const* in,
+                                   AudioFrame* out,
+                                   i32 num_frames)
+{
+    if (trance_gate.is_denormal_safe)
+    {
+        ScopedFlushDenormals const flush_denormals;
+        process_frames(trance_gate, in, out, num_frames);
+    }
+    else
+    {
+        process_frames(trance_gate, in, out, num_frames);
+    }
+}
+
+//------------------------------------------------------------------------
+void TranceGateImpl::process_block(TranceGate& trance_gate,
+                                   AudioFrame const* in,
+                                   AudioFrame* out,
+                                   i32 num_frames,
+                                   TranceGateMeterBuffer& meter_buffer)
+{
+    process_block(trance_gate, in, out, num_frames);
+    end_block(trance_gate, meter_buffer);
+}
+
+//------------------------------------------------------------------------
+void TranceGateImpl::end_block(TranceGate const& trance_gate,
+                               TranceGateMeterBuffer& meter_buffer)
+{
+    auto& meter = TripleBufferImpl::get_write_buffer(meter_buffer);
+
+    meter.step_pos          = trance_gate.step_val.pos;
+    meter.step_phase        = trance_gate.step_phase_val;
+    meter.fade_in_phase     = trance_gate.fade_in_phase_val;
+    meter.delay_phase       = trance_gate.delay_phase_val;
+    meter.is_delay_active =
+        trance_gate.is_delay_active && trance_gate.delay_phase_val < f32(1.);
+    meter.is_fade_in_active = trance_gate.is_fade_in_active;
+    meter.gate_gains        = trance_gate.gate_gains;
+
+    TripleBufferImpl::publish(meter_buffer);
+}
+
+//------------------------------------------------------------------------
+void TranceGateImpl::process_frames(TranceGate& trance_gate,
+                                    AudioFrame const* in,
+                                    AudioFrame* out,
+                                    i32 num_frames)
+{
+    using PhaseImpl   = dtb::modulation::PhaseImpl;
+    using OnePoleImpl = dtb::filtering::OnePoleImpl;
+    using GateValues  = std::array<mut_f32, KERNEL_BLOCK_SIZE>;
+
+    /*  Same as calling process for every frame, but split in two stages. The
+        step values and mixes are computed first, in runs of frames where
+        possible. Afterwards the hot loops run as kernels over all pending
+        frames.
+    */
+    auto const& kernels   = detail::get_gate_kernels();
+    auto& filters         = trance_gate.contour_filters;
+    auto const contour    = get_contour_coeffs(filters[TranceGate::L]);
+    bool is_delay_pending = trance_gate.is_delay_active;
+
+    alignas(64) GateValues values_le;
+    alignas(64) GateValues values_ri;
+    alignas(64) GateValues mixes;
+    mut_i32 first       = 0;
+    mut_i32 num_pending = 0;
+
+    auto const apply_kernels = [&]() {
+        if (num_pending == 0)
+            return;
+
+        kernels.apply_width(trance_gate.width, values_le.data(),
+                            values_ri.data(), num_pending);
+
+        // The first frame runs through the filters, their output is the
+        // exact filter state the contour kernel continues from.
+        apply_contour(trance_gate, values_le[0], values_ri[0]);
+        mut_f32 state_le = values_le[0];
+        mut_f32 state_ri = values_ri[0];
+        kernels.apply_contour(contour, trance_gate.is_denormal_safe, state_le,
+                              state_ri, values_le.data() + 1,
+                              values_ri.data() + 1, num_pending - 1);
+        OnePoleImpl::reset(filters[TranceGate::L], state_le);
+        OnePoleImpl::reset(filters[TranceGate::R], state_ri);
+
+        kernels.apply_mix(mixes.data(), values_le.data(), values_ri.data(),
+                          num_pending);
+        kernels.apply_gains(values_le.data(), values_ri.data(), in + first,
+                            out + first, num_pending);
+
+        trance_gate.gate_gains = {values_le[num_pending - 1],
+                                  values_ri[num_pending - 1]};
+        num_pending            = 0;
+    };
+
+    for (mut_i32 i = 0; i < num_frames;)
+    {
+        if (is_delay_pending)
+        {
+            bool const is_overflow = PhaseImpl::advance_one_shot(
+                trance_gate.delay_phase, trance_gate.delay_phase_val,
+                ONE_SAMPLE);
+            if (!is_overflow)
+            {
+                apply_kernels();
+                trance_gate.gate_gains = {f32(1.), f32(1.)};
+                out[i]                 = in[i];
+                ++i;
+                continue;
+            }
+
+            // Once overflown, the one shot delay phase stays there.
+            is_delay_pending = false;
+        }
+
+        if (num_pending == 0)
+            first = i;
+
+        i32 max_frames = std::min(num_frames - i,
+                                  KERNEL_BLOCK_SIZE - num_pending);
+        i32 num = compute_gate_values(trance_gate, &values_le[num_pending],
+                                      &values_ri[num_pending],
+                                      &mixes[num_pending], max_frames);
+        num_pending += num;
+        i += num;
+
+        if (num_pending == KERNEL_BLOCK_SIZE)
+            apply_kernels();
+    }
+
+    apply_kernels();
+}
+
+//------------------------------------------------------------------------
+i32 TranceGateImpl::compute_gate_values(TranceGate& trance_gate,
+                                        mut_f32* values_le,
+                                        mut_f32* values_ri,
+                                        mut_f32* mixes,
+                                        i32 max_frames)
+{
+    using PhaseImpl = dtb::modulation::PhaseImpl;
+
+    auto const& steps = trance_gate.channel_steps;
+
+    if (!trance_gate.is_sample_accurate)
+    {
+        // The float phase is accumulated frame by frame like in process.
+        for (mut_i32 i = 0; i < max_frames; ++i)
+        {
+            i32 pos      = trance_gate.step_val.pos;
+            values_le[i] = steps[TranceGate::L][pos];
+            values_ri[i] = steps[trance_gate.ch][pos];
+            apply_shuffle(trance_gate, values_le[i], values_ri[i]);
+            mixes[i] = compute_mix(trance_gate);
+
+            update_phases(trance_gate);
+        }
+
+        return max_frames;
+    }
+
+    /*  The timeline knows where the next step starts, so the run up to there
+        shares one step value. Only the shuffle needs the phase of each frame,
+        computed the same way as SampleTimelineImpl::get_step_phase.
+    */
+    auto& timeline = trance_gate.step_timeline;
+    u64 num_left   = SampleTimelineImpl::samples_until_next_step(timeline);
+    i32 num        = i32(std::min(num_left, u64(max_frames)));
+
+    i32 pos      = trance_gate.step_val.pos;
+    f32 value_le = steps[TranceGate::L][pos];
+    f32 value_ri = steps[trance_gate.ch][pos];
+    std::fill_n(values_le, num, value_le);
+    std::fill_n(values_ri, num, value_ri);
+
+    if (trance_gate.step_val.is_shuffle)
+    {
+        f32 delay         = compute_shuffle_delay(trance_gate);
+        mut_f32 phase_val = trance_gate.step_phase_val;
+        for (mut_i32 i = 0; i < num && !(phase_val > delay); ++i)
+        {
+            values_le[i] = f32(0.);
+            values_ri[i] = f32(0.);
+
+            u64 remainder = timeline.step_remainder +
+                            u64(i + 1) * timeline.step_len_den;
+            phase_val = f32(f64(remainder) / f64(timeline.step_len_num));
+        }
+    }
+
+    if (trance_gate.is_fade_in_active)
+    {
+        for (mut_i32 i = 0; i < num; ++i)
+        {
+            mixes[i] = compute_mix(trance_gate);
+            PhaseImpl::advance_one_shot(trance_gate.fade_in_phase,
+                                        trance_gate.fade_in_phase_val,
+                                        ONE_SAMPLE);
+        }
+    }
+    else
+    {
+        std::fill_n(mixes, num, trance_gate.mix);
+    }
+
+    bool is_overflow = SampleTimelineImpl::advance(timeline, num) > 0;
+    trance_gate.step_phase_val =
+        f32(SampleTimelineImpl::get_step_phase(timeline));
+    if (is_overflow)
+    {
+        ++trance_gate.step_val;
+        set_shuffle(trance_gate.step_val, trance_gate.step_phase.note_len);
+    }
+
+    return num;
+}
+
 //------------------------------------------------------------------------
 void TranceGateImpl::update_phases(TranceGate& trance_gate)
 {
     using PhaseImpl = dtb::modulation::PhaseImpl;
 
-    PhaseImpl::advance_one_shot(trance_gate.fade_in_phase,
-                                trance_gate.fade_in_phase_val, ONE_SAMPLE);
+    // The fade in phase is reset in trigger, no need to run it otherwise.
+    if (trance_gate.is_fade_in_active)
+        PhaseImpl::advance_one_shot(trance_gate.fade_in_phase,
+                                    trance_gate.fade_in_phase_val, ONE_SAMPLE);
 
     // When step_phase has overflown, increment step.
-    bool const is_overflow = PhaseImpl::advance(
-        trance_gate.step_phase, trance_gate.step_phase_val, ONE_SAMPLE);
+    bool is_overflow = false;
+    if (trance_gate.is_sample_accurate)
+    {
+        auto& timeline = trance_gate.step_timeline;
+        is_overflow    = SampleTimelineImpl::advance(timeline, ONE_SAMPLE) > 0;
+        trance_gate.step_phase_val =
+            f32(SampleTimelineImpl::get_step_phase(timeline));
+    }
+    else
+    {
+        is_overflow = PhaseImpl::advance(
+            trance_gate.step_phase, trance_gate.step_phase_val, ONE_SAMPLE);
+    }
+
     if (is_overflow)
     {
         ++trance_gate.step_val;
@@ -260,6 +542,7 @@ void TranceGateImpl::set_sample_rate(TranceGate& trance_gate, f32 value)
     PhaseImpl::set_sample_rate(trance_gate.delay_phase, value);
     PhaseImpl::set_sample_rate(trance_gate.fade_in_phase, value);
     PhaseImpl::set_sample_rate(trance_gate.step_phase, value);
+    SampleTimelineImpl::set_sample_rate(trance_gate.step_timeline, value);
 
     trance_gate.sample_rate = value;
 
@@ -304,6 +587,8 @@ void TranceGateImpl::set_step_len(TranceGate& trance_gate, f32 value_note_len)
     using PhaseImpl = dtb::modulation::PhaseImpl;
 
     PhaseImpl::set_note_len(trance_gate.step_phase, value_note_len);
+    SampleTimelineImpl::set_note_len(trance_gate.step_timeline,
+                                     value_note_len);
 }
 
 //------------------------------------------------------------------------
@@ -314,6 +599,7 @@ void TranceGateImpl::set_tempo(TranceGate& trance_gate, f32 value)
     PhaseImpl::set_tempo(trance_gate.delay_phase, value);
     PhaseImpl::set_tempo(trance_gate.fade_in_phase, value);
     PhaseImpl::set_tempo(trance_gate.step_phase, value);
+    SampleTimelineImpl::set_tempo(trance_gate.step_timeline, value);
 }
 
 //------------------------------------------------------------------------
@@ -325,6 +611,17 @@ void TranceGateImpl::update_project_time_music(TranceGate& trance_gate,
     PhaseImpl::set_project_time(trance_gate.delay_phase, value);
     PhaseImpl::set_project_time(trance_gate.fade_in_phase, value);
     PhaseImpl::set_project_time(trance_gate.step_phase, value);
+    SampleTimelineImpl::set_project_time_music(trance_gate.step_timeline,
+                                               value);
+    sync_step(trance_gate);
+}
+
+//------------------------------------------------------------------------
+void TranceGateImpl::update_project_time_samples(TranceGate& trance_gate,
+                                                 u64 value)
+{
+    SampleTimelineImpl::set_sample_pos(trance_gate.step_timeline, value);
+    sync_step(trance_gate);
 }
 
 //------------------------------------------------------------------------
@@ -0,0 +1,185 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/compact_trance_gate.h"
+#include "ha/fx_collection/trance_gate.h"
+
+#include "gtest/gtest.h"
+#include <stdexcept>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+TEST(compact_trance_gate_test, test_footprint)
+{
+    EXPECT_EQ(TranceGateImpl::footprint(), sizeof(TranceGate));
+    EXPECT_EQ(QuantizedTranceGateImpl::footprint(),
+              sizeof(QuantizedTranceGate));
+    EXPECT_LT(QuantizedTranceGateImpl::footprint(),
+              TranceGateImpl::footprint());
+    EXPECT_LT(BinaryTranceGateImpl::footprint(),
+              QuantizedTranceGateImpl::footprint());
+}
+
+//-----------------------------------------------------------------------------
+TEST(compact_trance_gate_test, test_quantized_steps)
+{
+    QuantizedSteps steps;
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        real value = real(i) / real(TranceGate::MAX_NUM_STEPS - 1);
+        StepStorageImpl::set(steps, TranceGate::R, i, value);
+        EXPECT_NEAR(StepStorageImpl::get(steps, TranceGate::R, i), value,
+                    real(0.5 / QuantizedSteps::MAX_VALUE));
+    }
+
+    EXPECT_EQ(StepStorageImpl::get(steps, TranceGate::L, 0), real(0.));
+    EXPECT_EQ(StepStorageImpl::get(steps, TranceGate::R, 0), real(0.));
+    EXPECT_EQ(StepStorageImpl::get(steps, TranceGate::R, 31), real(1.));
+}
+
+//-----------------------------------------------------------------------------
+TEST(compact_trance_gate_test, test_binary_steps)
+{
+    BinarySteps steps;
+    StepStorageImpl::set(steps, TranceGate::L, 0, real(1.));
+    StepStorageImpl::set(steps, TranceGate::L, 31, real(0.7));
+    StepStorageImpl::set(steps, TranceGate::R, 1, real(0.3));
+
+    EXPECT_EQ(StepStorageImpl::get(steps, TranceGate::L, 0), real(1.));
+    EXPECT_EQ(StepStorageImpl::get(steps, TranceGate::L, 1), real(0.));
+    EXPECT_EQ(StepStorageImpl::get(steps, TranceGate::L, 31), real(1.));
+    EXPECT_EQ(StepStorageImpl::get(steps, TranceGate::R, 1), real(0.));
+
+    StepStorageImpl::set(steps, TranceGate::L, 0, real(0.));
+    EXPECT_EQ(StepStorageImpl::get(steps, TranceGate::L, 0), real(0.));
+}
+
+//-----------------------------------------------------------------------------
+TEST(compact_trance_gate_test, test_steps_out_of_range)
+{
+    QuantizedSteps quantized_steps;
+    BinarySteps binary_steps;
+    for (auto const step : {-1, TranceGate::MAX_NUM_STEPS})
+    {
+        EXPECT_THROW(StepStorageImpl::set(quantized_steps, TranceGate::L,
+                                          step, real(1.)),
+                     std::out_of_range);
+        EXPECT_THROW(StepStorageImpl::set(binary_steps, TranceGate::L, step,
+                                          real(1.)),
+                     std::out_of_range);
+    }
+
+    EXPECT_THROW(StepStorageImpl::set(binary_steps, 2, 0, real(1.)),
+                 std::out_of_range);
+    EXPECT_EQ(binary_steps.bits[TranceGate::L], 0u);
+}
+
+//-----------------------------------------------------------------------------
+TEST(compact_trance_gate_test, test_matches_trance_gate)
+{
+    constexpr i32 NUM_FRAMES = 44100;
+
+    auto trance_gate = TranceGateImpl::create();
+    auto compact     = BinaryTranceGateImpl::create();
+
+    TranceGateImpl::set_sample_accurate(trance_gate, true);
+    TranceGateImpl::set_sample_rate(trance_gate, real(44100.));
+    TranceGateImpl::set_step_len(trance_gate, real(1. / 16.));
+    TranceGateImpl::set_stereo_mode(trance_gate, true);
+    TranceGateImpl::set_width(trance_gate, real(0.5));
+    TranceGateImpl::set_shuffle_amount(trance_gate, real(0.5));
+    TranceGateImpl::set_mix(trance_gate, real(0.9));
+
+    BinaryTranceGateImpl::set_sample_rate(compact, real(44100.));
+    BinaryTranceGateImpl::set_step_len(compact, real(1. / 16.));
+    BinaryTranceGateImpl::set_stereo_mode(compact, true);
+    BinaryTranceGateImpl::set_width(compact, real(0.5));
+    BinaryTranceGateImpl::set_shuffle_amount(compact, real(0.5));
+    BinaryTranceGateImpl::set_mix(compact, real(0.9));
+
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        real value_le = i % 3 ? real(1.) : real(0.);
+        real value_ri = i % 2 ? real(1.) : real(0.);
+        TranceGateImpl::set_step(trance_gate, TranceGate::L, i, value_le);
+        TranceGateImpl::set_step(trance_gate, TranceGate::R, i, value_ri);
+        BinaryTranceGateImpl::set_step(compact, TranceGate::L, i, value_le);
+        BinaryTranceGateImpl::set_step(compact, TranceGate::R, i, value_ri);
+    }
+
+    AudioFrame const in{real(1.), real(1.)};
+    for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+    {
+        AudioFrame out         = zero_audio_frame;
+        AudioFrame compact_out = zero_audio_frame;
+        TranceGateImpl::process(trance_gate, in, out);
+        BinaryTranceGateImpl::process(compact, in, compact_out);
+
+        ASSERT_NEAR(compact_out.data[0], out.data[0], real(1e-6)) << i;
+        ASSERT_NEAR(compact_out.data[1], out.data[1], real(1e-6)) << i;
+    }
+
+    EXPECT_EQ(BinaryTranceGateImpl::get_step_pos(compact),
+              TranceGateImpl::get_step_pos(trance_gate));
+}
+
+//-----------------------------------------------------------------------------
+TEST(compact_trance_gate_test, test_delay_and_fade_in)
+{
+    auto gate = QuantizedTranceGateImpl::create();
+    QuantizedTranceGateImpl::set_sample_rate(gate, real(44100.));
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        QuantizedTranceGateImpl::set_step(gate, TranceGate::L, i, real(0.));
+        QuantizedTranceGateImpl::set_step(gate, TranceGate::R, i, real(0.));
+    }
+
+    // 1/32 at 120 BPM lasts 2756.25 samples, rounded to 2756.
+    QuantizedTranceGateImpl::trigger(gate, real(1. / 32.), real(1. / 32.));
+    EXPECT_EQ(gate.delay_len, 2756);
+    EXPECT_EQ(gate.fade_in_len, 2756);
+
+    AudioFrame const in{real(1.), real(1.)};
+    AudioFrame out = zero_audio_frame;
+    for (mut_i32 i = 0; i < 2756; ++i)
+    {
+        QuantizedTranceGateImpl::process(gate, in, out);
+        ASSERT_EQ(out.data[0], real(1.));
+    }
+
+    // Fade in starts at zero mix, so the closed gate still passes through.
+    QuantizedTranceGateImpl::process(gate, in, out);
+    EXPECT_EQ(out.data[0], real(1.));
+    EXPECT_EQ(QuantizedTranceGateImpl::get_step_pos(gate), 0);
+
+    for (mut_i32 i = 0; i < 2756; ++i)
+        QuantizedTranceGateImpl::process(gate, in, out);
+    EXPECT_LT(out.data[0], real(1.));
+}
+
+//-----------------------------------------------------------------------------
+TEST(compact_trance_gate_test, test_filter_states_are_snapped_to_zero)
+{
+    using OnePoleImpl = ha::dtb::filtering::OnePoleImpl;
+
+    auto gate = BinaryTranceGateImpl::create();
+    BinaryTranceGateImpl::set_contour(gate, real(0.001));
+    BinaryTranceGateImpl::set_denormal_safe(gate, true);
+    for (auto& filter : gate.contour_filters)
+        OnePoleImpl::reset(filter, real(1.));
+
+    AudioFrame const in{real(1.), real(1.)};
+    AudioFrame out = zero_audio_frame;
+    for (mut_i32 i = 0; i < 44100; ++i)
+        BinaryTranceGateImpl::process(gate, in, out);
+
+    // With an input of zero, the filter outputs its scaled state.
+    for (auto filter : gate.contour_filters)
+        EXPECT_EQ(OnePoleImpl::process(filter, real(0.)), real(0.));
+    EXPECT_EQ(out.data[TranceGate::L], real(0.));
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
@@ -0,0 +1,256 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "detail/gate_kernels.h"
+#include "ha/fx_collection/cpu_dispatch.h"
+#include "ha/fx_collection/trance_gate.h"
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+constexpr Isa ALL_ISAS[] = {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512};
+constexpr i32 NUM_FRAMES = 67;
+
+// The vector contour kernels sum in a different order than the recursion.
+constexpr f32 CONTOUR_TOLERANCE = f32(1e-5);
+
+//-----------------------------------------------------------------------------
+std::vector<mut_f32> random_values(i32 num, u32 seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<mut_f32> distribution(0.f, 1.f);
+
+    std::vector<mut_f32> values(num);
+    for (auto& value : values)
+        value = distribution(generator);
+
+    return values;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<AudioFrame> random_frames(i32 num, u32 seed)
+{
+    auto const values = random_values(num * 4, seed);
+
+    std::vector<AudioFrame> frames(num);
+    for (mut_i32 i = 0; i < num; ++i)
+        for (mut_i32 ch = 0; ch < 4; ++ch)
+            frames[i].data[ch] = values[i * 4 + ch] - real(0.5);
+
+    return frames;
+}
+
+//-----------------------------------------------------------------------------
+detail::ContourCoeffs make_contour(f64 tau)
+{
+    detail::ContourCoeffs contour;
+    contour.pole = f32(std::exp(-1. / (tau * 44100.)));
+    contour.gain = real(1.) - contour.pole;
+
+    return contour;
+}
+
+//-----------------------------------------------------------------------------
+TranceGate create_trance_gate(bool is_sample_accurate)
+{
+    auto trance_gate = TranceGateImpl::create();
+    TranceGateImpl::set_sample_rate(trance_gate, real(44100.));
+    TranceGateImpl::set_tempo(trance_gate, real(180.));
+    TranceGateImpl::set_step_len(trance_gate, real(1. / 64.));
+    TranceGateImpl::set_step_count(trance_gate, 16);
+    TranceGateImpl::set_stereo_mode(trance_gate, true);
+    TranceGateImpl::set_width(trance_gate, real(0.3));
+    TranceGateImpl::set_shuffle_amount(trance_gate, real(0.5));
+    TranceGateImpl::set_mix(trance_gate, real(0.8));
+    TranceGateImpl::set_sample_accurate(trance_gate, is_sample_accurate);
+
+    auto const steps = random_values(2 * TranceGate::MAX_NUM_STEPS, 7);
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        TranceGateImpl::set_step(trance_gate, TranceGate::L, i, steps[i]);
+        TranceGateImpl::set_step(trance_gate, TranceGate::R, i,
+                                 steps[TranceGate::MAX_NUM_STEPS + i]);
+    }
+
+    TranceGateImpl::trigger(trance_gate, real(1. / 128.), real(1. / 8.));
+    return trance_gate;
+}
+
+//-----------------------------------------------------------------------------
+TEST(cpu_dispatch_test, test_detected_isa_is_supported)
+{
+    EXPECT_NE(detail::get_gate_kernels(detect_isa()), nullptr);
+    EXPECT_NE(detail::get_gate_kernels(Isa::Scalar), nullptr);
+    EXPECT_EQ(&detail::get_gate_kernels(),
+              detail::get_gate_kernels(get_active_isa()));
+
+    for (auto isa : ALL_ISAS)
+        EXPECT_EQ(detail::get_gate_kernels(isa) != nullptr,
+                  isa <= detect_isa());
+}
+
+//-----------------------------------------------------------------------------
+TEST(cpu_dispatch_test, test_kernels_match_scalar)
+{
+    auto const& reference = *detail::get_gate_kernels(Isa::Scalar);
+    auto const mixes      = random_values(NUM_FRAMES, 1);
+    auto const in         = random_frames(NUM_FRAMES, 2);
+
+    for (auto isa : ALL_ISAS)
+    {
+        auto const* kernels = detail::get_gate_kernels(isa);
+        if (!kernels)
+            continue;
+
+        SCOPED_TRACE(static_cast<int>(isa));
+
+        // The shortest, a typical and the longest contour in [s].
+        for (auto const tau : {0.001, 0.01, 4.})
+        {
+            SCOPED_TRACE(tau);
+            auto const contour = make_contour(tau);
+
+            for (mut_i32 num = 0; num <= NUM_FRAMES; ++num)
+            {
+                auto ref_le = random_values(NUM_FRAMES, 3);
+                auto ref_ri = random_values(NUM_FRAMES, 4);
+                auto le     = ref_le;
+                auto ri     = ref_ri;
+
+                reference.apply_width(real(0.7), ref_le.data(), ref_ri.data(),
+                                      num);
+                kernels->apply_width(real(0.7), le.data(), ri.data(), num);
+                for (auto const is_denormal_safe : {false, true})
+                {
+                    mut_f32 ref_state_le = real(0.25);
+                    mut_f32 ref_state_ri = real(1e-14);
+                    mut_f32 state_le     = ref_state_le;
+                    mut_f32 state_ri     = ref_state_ri;
+                    reference.apply_contour(contour, is_denormal_safe,
+                                            ref_state_le, ref_state_ri,
+                                            ref_le.data(), ref_ri.data(), num);
+                    kernels->apply_contour(contour, is_denormal_safe,
+                                           state_le, state_ri, le.data(),
+                                           ri.data(), num);
+                    EXPECT_NEAR(state_le, ref_state_le, CONTOUR_TOLERANCE);
+                    EXPECT_NEAR(state_ri, ref_state_ri, CONTOUR_TOLERANCE);
+                }
+                reference.apply_mix(mixes.data(), ref_le.data(),
+                                    ref_ri.data(), num);
+                kernels->apply_mix(mixes.data(), le.data(), ri.data(), num);
+
+                auto ref_out = random_frames(NUM_FRAMES, 5);
+                auto out     = ref_out;
+                reference.apply_gains(ref_le.data(), ref_ri.data(),
+                                      in.data(), ref_out.data(), num);
+                kernels->apply_gains(le.data(), ri.data(), in.data(),
+                                     out.data(), num);
+
+                for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+                {
+                    EXPECT_NEAR(le[i], ref_le[i], CONTOUR_TOLERANCE);
+                    EXPECT_NEAR(ri[i], ref_ri[i], CONTOUR_TOLERANCE);
+                    for (mut_i32 ch = 0; ch < 4; ++ch)
+                        EXPECT_NEAR(out[i].data[ch], ref_out[i].data[ch],
+                                    CONTOUR_TOLERANCE);
+                }
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST(cpu_dispatch_test, test_long_contour_steady_state)
+{
+    constexpr i32 NUM_BLOCKS = 40000;
+
+    // Per frame, the float recursion loses increments below half an ulp of
+    // the state. The kernels update it once per lane group, so they settle
+    // closer to one, but never further away than the scalar recursion.
+    auto const contour = make_contour(4.);
+    f32 const max_error =
+        std::numeric_limits<mut_f32>::epsilon() / (real(2.) * contour.gain);
+
+    for (auto isa : ALL_ISAS)
+    {
+        auto const* kernels = detail::get_gate_kernels(isa);
+        if (!kernels)
+            continue;
+
+        SCOPED_TRACE(static_cast<int>(isa));
+        mut_f32 state_le = real(0.);
+        mut_f32 state_ri = real(0.);
+        std::vector<mut_f32> le(NUM_FRAMES);
+        std::vector<mut_f32> ri(NUM_FRAMES);
+        for (mut_i32 i = 0; i < NUM_BLOCKS; ++i)
+        {
+            std::fill(le.begin(), le.end(), real(1.));
+            std::fill(ri.begin(), ri.end(), real(1.));
+            kernels->apply_contour(contour, true, state_le, state_ri,
+                                   le.data(), ri.data(), NUM_FRAMES);
+        }
+
+        EXPECT_NEAR(state_le, real(1.), max_error);
+        EXPECT_EQ(state_le, state_ri);
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST(cpu_dispatch_test, test_process_block_matches_process)
+{
+    constexpr i32 NUM_BLOCK_FRAMES = 8192;
+    constexpr i32 BLOCK_SIZE       = 333;
+
+    auto const in = random_frames(NUM_BLOCK_FRAMES, 6);
+
+    Isa const detected = detect_isa();
+    for (auto const is_sample_accurate : {false, true})
+    {
+        SCOPED_TRACE(is_sample_accurate);
+
+        auto trance_gate = create_trance_gate(is_sample_accurate);
+        std::vector<AudioFrame> ref_out(NUM_BLOCK_FRAMES, zero_audio_frame);
+        for (mut_i32 i = 0; i < NUM_BLOCK_FRAMES; ++i)
+            TranceGateImpl::process(trance_gate, in[i], ref_out[i]);
+
+        for (auto isa : ALL_ISAS)
+        {
+            if (!force_isa(isa))
+            {
+                EXPECT_GT(isa, detected);
+                continue;
+            }
+
+            SCOPED_TRACE(static_cast<int>(isa));
+            EXPECT_EQ(get_active_isa(), isa);
+
+            trance_gate = create_trance_gate(is_sample_accurate);
+            std::vector<AudioFrame> out(NUM_BLOCK_FRAMES, zero_audio_frame);
+            for (mut_i32 i = 0; i < NUM_BLOCK_FRAMES; i += BLOCK_SIZE)
+            {
+                i32 num = std::min(BLOCK_SIZE, NUM_BLOCK_FRAMES - i);
+                TranceGateImpl::process_block(trance_gate, &in[i], &out[i],
+                                              num);
+            }
+
+            for (mut_i32 i = 0; i < NUM_BLOCK_FRAMES; ++i)
+                for (mut_i32 ch = 0; ch < 4; ++ch)
+                    ASSERT_NEAR(out[i].data[ch], ref_out[i].data[ch],
+                                CONTOUR_TOLERANCE)
+                        << i;
+        }
+
+        force_isa(detected);
+    }
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
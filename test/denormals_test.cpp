@@ -0,0 +1,121 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/denormals.h"
+#include "ha/fx_collection/trance_gate.h"
+
+#include "gtest/gtest.h"
+#include <cmath>
+#include <limits>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+TEST(denormals_test, test_scoped_flush_restores_state)
+{
+    bool const was_enabled = is_flush_denormals_enabled();
+    {
+        ScopedFlushDenormals const flush_denormals;
+        EXPECT_EQ(is_flush_denormals_enabled(),
+                  is_flush_denormals_supported());
+    }
+    EXPECT_EQ(is_flush_denormals_enabled(), was_enabled);
+}
+
+//-----------------------------------------------------------------------------
+TEST(denormals_test, test_scoped_flush_flushes_results)
+{
+    if (!is_flush_denormals_supported())
+        GTEST_SKIP();
+
+    volatile mut_f32 value = std::numeric_limits<mut_f32>::min();
+    {
+        ScopedFlushDenormals const flush_denormals;
+        value = value * real(0.5);
+    }
+    EXPECT_EQ(value, real(0.));
+}
+
+//-----------------------------------------------------------------------------
+static TranceGate create_closed_gate(bool is_denormal_safe)
+{
+    auto trance_gate = TranceGateImpl::create();
+    TranceGateImpl::set_sample_rate(trance_gate, real(44100.));
+    TranceGateImpl::set_contour(trance_gate, real(0.001));
+    TranceGateImpl::set_denormal_safe(trance_gate, is_denormal_safe);
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        TranceGateImpl::set_step(trance_gate, TranceGate::L, i, real(0.));
+        TranceGateImpl::set_step(trance_gate, TranceGate::R, i, real(0.));
+    }
+    for (auto& filter : trance_gate.contour_filters)
+        ha::dtb::filtering::OnePoleImpl::reset(filter, real(1.));
+
+    return trance_gate;
+}
+
+//-----------------------------------------------------------------------------
+static bool is_filter_state_zero(TranceGate const& trance_gate, i32 ch)
+{
+    // With an input of zero, the filter outputs its scaled state.
+    auto filter = trance_gate.contour_filters[ch];
+    return ha::dtb::filtering::OnePoleImpl::process(filter, real(0.)) ==
+           real(0.);
+}
+
+//-----------------------------------------------------------------------------
+TEST(denormals_test, test_filter_states_are_snapped_to_zero)
+{
+    constexpr i32 NUM_FRAMES = 44100;
+
+    // Per frame processing does not enable FTZ, the filters are snapped.
+    auto trance_gate = create_closed_gate(true);
+    AudioFrame const in{real(1.), real(1.)};
+    AudioFrame out = zero_audio_frame;
+    for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+        TranceGateImpl::process(trance_gate, in, out);
+
+    for (mut_i32 ch = TranceGate::L; ch <= TranceGate::R; ++ch)
+    {
+        EXPECT_TRUE(is_filter_state_zero(trance_gate, ch));
+        EXPECT_EQ(out.data[ch], real(0.));
+    }
+
+    // Without snapping, the filters end up in the subnormal range.
+    if (is_flush_denormals_enabled())
+        return;
+
+    auto unsafe_trance_gate = create_closed_gate(false);
+    for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+        TranceGateImpl::process(unsafe_trance_gate, in, out);
+
+    for (mut_i32 ch = TranceGate::L; ch <= TranceGate::R; ++ch)
+        EXPECT_FALSE(is_filter_state_zero(unsafe_trance_gate, ch));
+}
+
+//-----------------------------------------------------------------------------
+TEST(denormals_test, test_process_block_flushes_to_zero)
+{
+    constexpr i32 NUM_FRAMES = 44100;
+
+    bool const was_enabled = is_flush_denormals_enabled();
+    auto trance_gate       = create_closed_gate(true);
+    std::vector<AudioFrame> in(NUM_FRAMES, AudioFrame{real(1.), real(1.)});
+    std::vector<AudioFrame> out(NUM_FRAMES, zero_audio_frame);
+    TranceGateImpl::process_block(trance_gate, in.data(), out.data(),
+                                  NUM_FRAMES);
+
+    for (mut_i32 ch = TranceGate::L; ch <= TranceGate::R; ++ch)
+    {
+        EXPECT_EQ(out.back().data[ch], real(0.));
+        EXPECT_NE(std::fpclassify(out.back().data[ch]), FP_SUBNORMAL);
+        EXPECT_TRUE(is_filter_state_zero(trance_gate, ch));
+    }
+
+    // FTZ is only enabled while the block is processed.
+    EXPECT_EQ(is_flush_denormals_enabled(), was_enabled);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
@@ -0,0 +1,86 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/effect_chain.h"
+#include "ha/fx_collection/gain_pan.h"
+#include "ha/fx_collection/trance_gate.h"
+
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+using ChainImpl = EffectChainImpl<Effect<TranceGate, TranceGateImpl>,
+                                  Effect<GainPan, GainPanImpl>>;
+
+//-----------------------------------------------------------------------------
+static void setup_trance_gate(TranceGate& trance_gate)
+{
+    TranceGateImpl::set_sample_rate(trance_gate, real(44100.));
+    TranceGateImpl::set_step_count(trance_gate, 4);
+    for (mut_i32 i = 0; i < TranceGate::MAX_NUM_STEPS; ++i)
+    {
+        real value = i % 2 ? real(0.) : real(1.);
+        TranceGateImpl::set_step(trance_gate, TranceGate::L, i, value);
+        TranceGateImpl::set_step(trance_gate, TranceGate::R, i, value);
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST(effect_chain_test, test_matches_sequential_processing)
+{
+    constexpr i32 NUM_FRAMES = 4096;
+
+    auto chain = ChainImpl::create();
+    setup_trance_gate(ChainImpl::get<0>(chain));
+    GainPanImpl::set_gain(ChainImpl::get<1>(chain), real(0.5));
+    GainPanImpl::set_pan(ChainImpl::get<1>(chain), real(0.25));
+
+    auto trance_gate = TranceGateImpl::create();
+    setup_trance_gate(trance_gate);
+    auto gain_pan = GainPanImpl::create();
+    GainPanImpl::set_gain(gain_pan, real(0.5));
+    GainPanImpl::set_pan(gain_pan, real(0.25));
+
+    std::vector<AudioFrame> in(NUM_FRAMES);
+    for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+        in[i] = AudioFrame{real(0.5), real(-0.25), real(0.1), real(0.2)};
+
+    std::vector<AudioFrame> chain_out(NUM_FRAMES, zero_audio_frame);
+    ChainImpl::process_block(chain, in.data(), chain_out.data(), NUM_FRAMES);
+
+    std::vector<AudioFrame> tmp(in);
+    std::vector<AudioFrame> out(NUM_FRAMES, zero_audio_frame);
+    TranceGateImpl::process_block(trance_gate, in.data(), tmp.data(),
+                                  NUM_FRAMES);
+    for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+        GainPanImpl::process(gain_pan, tmp[i], out[i]);
+
+    for (mut_i32 i = 0; i < NUM_FRAMES; ++i)
+        for (mut_i32 ch = 0; ch < out[i].data.size(); ++ch)
+            EXPECT_NEAR(chain_out[i].data[ch], out[i].data[ch], real(1e-5));
+}
+
+//-----------------------------------------------------------------------------
+TEST(effect_chain_test, test_end_block_after_chain)
+{
+    constexpr i32 NUM_FRAMES = 64;
+
+    TranceGateMeterBuffer meter_buffer;
+    auto chain = ChainImpl::create();
+    setup_trance_gate(ChainImpl::get<0>(chain));
+
+    std::vector<AudioFrame> in(NUM_FRAMES, AudioFrame{real(1.), real(1.)});
+    std::vector<AudioFrame> out(NUM_FRAMES, zero_audio_frame);
+    ChainImpl::process_block(chain, in.data(), out.data(), NUM_FRAMES);
+    TranceGateImpl::end_block(ChainImpl::get<0>(chain), meter_buffer);
+
+    EXPECT_TRUE(TripleBufferImpl::fetch(meter_buffer));
+    auto const& meter = TripleBufferImpl::get_read_buffer(meter_buffer);
+    EXPECT_EQ(meter.step_phase, ChainImpl::get<0>(chain).step_phase_val);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
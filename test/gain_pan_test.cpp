@@ -0,0 +1,43 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/gain_pan.h"
+
+#include "gtest/gtest.h"
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+TEST(gain_pan_test, test_center_is_constant_power)
+{
+    auto gain_pan = GainPanImpl::create();
+    EXPECT_NEAR(gain_pan.gain_le * gain_pan.gain_le +
+                    gain_pan.gain_ri * gain_pan.gain_ri,
+                real(1.), real(1e-6));
+    EXPECT_FLOAT_EQ(gain_pan.gain_le, gain_pan.gain_ri);
+
+    GainPan const default_gain_pan;
+    EXPECT_FLOAT_EQ(default_gain_pan.gain_le, gain_pan.gain_le);
+    EXPECT_FLOAT_EQ(default_gain_pan.gain_ri, gain_pan.gain_ri);
+}
+
+//-----------------------------------------------------------------------------
+TEST(gain_pan_test, test_processing)
+{
+    auto gain_pan = GainPanImpl::create();
+    GainPanImpl::set_gain(gain_pan, real(0.5));
+    GainPanImpl::set_pan(gain_pan, real(0.));
+
+    AudioFrame const in{real(1.), real(1.), real(1.), real(1.)};
+    AudioFrame out = zero_audio_frame;
+    GainPanImpl::process(gain_pan, in, out);
+
+    EXPECT_FLOAT_EQ(out.data[0], real(0.5));
+    EXPECT_NEAR(out.data[1], real(0.), real(1e-6));
+    EXPECT_FLOAT_EQ(out.data[2], real(1.));
+    EXPECT_FLOAT_EQ(out.data[3], real(1.));
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
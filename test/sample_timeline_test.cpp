@@ -0,0 +1,136 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/sample_timeline.h"
+#include "ha/fx_collection/trance_gate.h"
+
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+constexpr u32 BLOCK_SIZE = 512;
+
+//-----------------------------------------------------------------------------
+u64 advance_blocks(SampleTimeline& timeline, u64 num_samples)
+{
+    mut_u64 num_steps = 0;
+    for (mut_u64 pos = 0; pos < num_samples; pos += BLOCK_SIZE)
+    {
+        u32 num = u32(std::min(u64(BLOCK_SIZE), num_samples - pos));
+        num_steps += SampleTimelineImpl::advance(timeline, num);
+    }
+
+    return num_steps;
+}
+
+//-----------------------------------------------------------------------------
+TEST(sample_timeline_test, test_step_len)
+{
+    // 1/16 at 120 BPM and 44.1kHz lasts 5512.5 samples.
+    auto timeline = SampleTimelineImpl::create();
+    SampleTimelineImpl::set_sample_rate(timeline, 44100.);
+    SampleTimelineImpl::set_tempo(timeline, 120.);
+    SampleTimelineImpl::set_note_len(timeline, 1. / 16.);
+
+    EXPECT_EQ(timeline.step_len_num, 11025);
+    EXPECT_EQ(timeline.step_len_den, 2);
+}
+
+//-----------------------------------------------------------------------------
+TEST(sample_timeline_test, test_no_drift_after_24_hours)
+{
+    constexpr u64 SAMPLE_RATE  = 44100;
+    constexpr u64 NUM_SAMPLES  = 24 * 60 * 60 * SAMPLE_RATE;
+    constexpr u64 NUM_EXPECTED = NUM_SAMPLES * 2 / 11025;
+
+    auto timeline = SampleTimelineImpl::create();
+    SampleTimelineImpl::set_sample_rate(timeline, f64(SAMPLE_RATE));
+    SampleTimelineImpl::set_tempo(timeline, 120.);
+    SampleTimelineImpl::set_note_len(timeline, 1. / 16.);
+
+    EXPECT_EQ(advance_blocks(timeline, NUM_SAMPLES), NUM_EXPECTED);
+    EXPECT_EQ(timeline.sample_pos, NUM_SAMPLES);
+    EXPECT_EQ(timeline.step_index, NUM_EXPECTED);
+    EXPECT_EQ(timeline.step_remainder, 0);
+    EXPECT_EQ(SampleTimelineImpl::get_step_phase(timeline), 0.);
+}
+
+//-----------------------------------------------------------------------------
+TEST(sample_timeline_test, test_no_drift_after_24_hours_odd_tempo)
+{
+    constexpr u64 SAMPLE_RATE = 48000;
+    constexpr u64 NUM_SAMPLES = 24 * 60 * 60 * SAMPLE_RATE;
+
+    auto timeline = SampleTimelineImpl::create();
+    SampleTimelineImpl::set_sample_rate(timeline, f64(SAMPLE_RATE));
+    SampleTimelineImpl::set_tempo(timeline, 123.457);
+    SampleTimelineImpl::set_note_len(timeline, 1. / 48.);
+    advance_blocks(timeline, NUM_SAMPLES);
+
+    // Seeking computes the position directly, without any accumulation.
+    auto expected = timeline;
+    SampleTimelineImpl::set_sample_pos(expected, NUM_SAMPLES);
+
+    EXPECT_EQ(timeline.sample_pos, expected.sample_pos);
+    EXPECT_EQ(timeline.step_index, expected.step_index);
+    EXPECT_EQ(timeline.step_remainder, expected.step_remainder);
+}
+
+//-----------------------------------------------------------------------------
+TEST(sample_timeline_test, test_samples_until_next_step)
+{
+    auto timeline = SampleTimelineImpl::create();
+    SampleTimelineImpl::set_sample_rate(timeline, 44100.);
+    SampleTimelineImpl::set_tempo(timeline, 97.3);
+    SampleTimelineImpl::set_note_len(timeline, 3. / 64.);
+
+    for (mut_i32 step = 0; step < 100; ++step)
+    {
+        u64 num_samples = SampleTimelineImpl::samples_until_next_step(timeline);
+        EXPECT_EQ(SampleTimelineImpl::advance(timeline, u32(num_samples - 1)),
+                  0);
+        EXPECT_EQ(SampleTimelineImpl::advance(timeline, 1), 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST(sample_timeline_test, test_tempo_change_keeps_step_phase)
+{
+    auto timeline = SampleTimelineImpl::create();
+    SampleTimelineImpl::set_note_len(timeline, 1. / 4.);
+    SampleTimelineImpl::advance(timeline, 11025); // Half a quarter note
+
+    SampleTimelineImpl::set_tempo(timeline, 60.);
+    EXPECT_DOUBLE_EQ(SampleTimelineImpl::get_step_phase(timeline), 0.5);
+    EXPECT_EQ(SampleTimelineImpl::samples_until_next_step(timeline), 22050);
+}
+
+//-----------------------------------------------------------------------------
+TEST(sample_timeline_test, test_trance_gate_sample_accurate)
+{
+    AudioFrame const in{real(1.), real(1.)};
+    AudioFrame out = zero_audio_frame;
+
+    auto trance_gate = TranceGateImpl::create();
+    TranceGateImpl::set_sample_rate(trance_gate, real(44100.));
+    TranceGateImpl::set_step_len(trance_gate, real(1. / 16.));
+    TranceGateImpl::set_sample_accurate(trance_gate, true);
+
+    // Steps last 5512.5 samples, the first one ends after 5513 samples.
+    for (mut_i32 i = 0; i < 5512; ++i)
+        TranceGateImpl::process(trance_gate, in, out);
+    EXPECT_EQ(TranceGateImpl::get_step_pos(trance_gate), 0);
+
+    TranceGateImpl::process(trance_gate, in, out);
+    EXPECT_EQ(TranceGateImpl::get_step_pos(trance_gate), 1);
+
+    for (mut_i32 i = 0; i < 5512; ++i)
+        TranceGateImpl::process(trance_gate, in, out);
+    EXPECT_EQ(TranceGateImpl::get_step_pos(trance_gate), 2);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace
@@ -4,6 +4,7 @@
 #include "ha/fx_collection/trance_gate.h"
 
 #include "gtest/gtest.h"
+#include <type_traits>
 
 using namespace ha::fx_collection;
 
@@ -72,6 +73,96 @@ TEST(trance_gate_test, test_processing)
     EXPECT_TRUE(sum.data[1] < real(469.));
 }
 
+//-----------------------------------------------------------------------------
+TEST(trance_gate_test, test_publish_meter)
+{
+    constexpr i32 NUM_FRAMES = 64;
+
+    TranceGateMeterBuffer meter_buffer;
+    auto trance_gate = TranceGateImpl::create();
+    TranceGateImpl::set_sample_rate(trance_gate, real(44100.));
+    TranceGateImpl::set_step(trance_gate, TranceGate::L, 0, real(1.));
+    TranceGateImpl::set_step(trance_gate, TranceGate::R, 0, real(1.));
+    TranceGateImpl::trigger(trance_gate, real(0.), real(1. / 4.));
+
+    std::array<AudioFrame, NUM_FRAMES> in;
+    in.fill(AudioFrame{real(1.), real(1.)});
+    std::array<AudioFrame, NUM_FRAMES> out;
+    TranceGateImpl::process_block(trance_gate, in.data(), out.data(),
+                                  NUM_FRAMES, meter_buffer);
+
+    EXPECT_TRUE(TripleBufferImpl::fetch(meter_buffer));
+    auto const& meter = TripleBufferImpl::get_read_buffer(meter_buffer);
+    EXPECT_EQ(meter.step_pos, TranceGateImpl::get_step_pos(trance_gate));
+    EXPECT_EQ(meter.step_phase, trance_gate.step_phase_val);
+    EXPECT_EQ(meter.fade_in_phase, trance_gate.fade_in_phase_val);
+    EXPECT_TRUE(meter.is_fade_in_active);
+    EXPECT_FALSE(meter.is_delay_active);
+    EXPECT_EQ(meter.gate_gains[TranceGate::L], out.back().data[TranceGate::L]);
+    EXPECT_EQ(meter.gate_gains[TranceGate::R], out.back().data[TranceGate::R]);
+    EXPECT_FALSE(TripleBufferImpl::fetch(meter_buffer));
+}
+
+//-----------------------------------------------------------------------------
+TEST(trance_gate_test, test_publish_meter_delay)
+{
+    constexpr i32 NUM_FRAMES = 64;
+
+    TranceGateMeterBuffer meter_buffer;
+    auto trance_gate = TranceGateImpl::create();
+    TranceGateImpl::set_sample_rate(trance_gate, real(44100.));
+    TranceGateImpl::trigger(trance_gate, real(1. / 32.));
+
+    // A 1/32 note at 120 BPM is 2756.25 samples long.
+    std::array<AudioFrame, NUM_FRAMES> in;
+    in.fill(AudioFrame{real(1.), real(1.)});
+    std::array<AudioFrame, NUM_FRAMES> out;
+    TranceGateImpl::process_block(trance_gate, in.data(), out.data(),
+                                  NUM_FRAMES, meter_buffer);
+    EXPECT_TRUE(TripleBufferImpl::fetch(meter_buffer));
+    EXPECT_TRUE(
+        TripleBufferImpl::get_read_buffer(meter_buffer).is_delay_active);
+
+    for (mut_i32 i = 0; i < 50; ++i)
+        TranceGateImpl::process_block(trance_gate, in.data(), out.data(),
+                                      NUM_FRAMES, meter_buffer);
+    EXPECT_TRUE(TripleBufferImpl::fetch(meter_buffer));
+    EXPECT_FALSE(
+        TripleBufferImpl::get_read_buffer(meter_buffer).is_delay_active);
+}
+
+//-----------------------------------------------------------------------------
+TEST(trance_gate_test, test_project_time_moves_step_pos)
+{
+    auto trance_gate = TranceGateImpl::create();
+    TranceGateImpl::set_sample_rate(trance_gate, real(44100.));
+    TranceGateImpl::set_tempo(trance_gate, real(120.));
+    TranceGateImpl::set_step_len(trance_gate, real(1. / 16.));
+    TranceGateImpl::set_step_count(trance_gate, 32);
+    TranceGateImpl::set_sample_accurate(trance_gate, true);
+
+    // A 1/16 note at 120 BPM is 5512.5 samples long.
+    TranceGateImpl::update_project_time_samples(trance_gate, 5513 * 5 + 100);
+    EXPECT_EQ(TranceGateImpl::get_step_pos(trance_gate), 5);
+    EXPECT_EQ(trance_gate.step_val.is_shuffle,
+              detail::is_shuffle_note(5, real(1. / 16.)));
+    EXPECT_GT(trance_gate.step_phase_val, real(0.));
+
+    TranceGateImpl::update_project_time_music(trance_gate, 4.);
+    EXPECT_EQ(TranceGateImpl::get_step_pos(trance_gate), 16);
+    EXPECT_EQ(trance_gate.step_phase_val, real(0.));
+
+    TranceGateImpl::set_step_count(trance_gate, 16);
+    TranceGateImpl::update_project_time_music(trance_gate, 5.);
+    EXPECT_EQ(TranceGateImpl::get_step_pos(trance_gate), 4);
+}
+
+//-----------------------------------------------------------------------------
+TEST(trance_gate_test, test_is_trivially_copyable)
+{
+    EXPECT_TRUE(std::is_trivially_copyable_v<TranceGate>);
+}
+
 //-----------------------------------------------------------------------------
 TEST(trance_gate_test, test_is_shuffle_note_16)
 {
@@ -0,0 +1,75 @@
+// Copyright(c) 2021 Hansen Audio.
+
+#include "ha/fx_collection/triple_buffer.h"
+
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+
+using namespace ha::fx_collection;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+struct Snapshot
+{
+    std::array<mut_u64, 16> values{};
+};
+
+//-----------------------------------------------------------------------------
+TEST(triple_buffer_test, test_fetch_latest)
+{
+    TripleBuffer<mut_i32> triple_buffer;
+    EXPECT_FALSE(TripleBufferImpl::fetch(triple_buffer));
+
+    TripleBufferImpl::get_write_buffer(triple_buffer) = 1;
+    TripleBufferImpl::publish(triple_buffer);
+    TripleBufferImpl::get_write_buffer(triple_buffer) = 2;
+    TripleBufferImpl::publish(triple_buffer);
+
+    EXPECT_TRUE(TripleBufferImpl::fetch(triple_buffer));
+    EXPECT_EQ(TripleBufferImpl::get_read_buffer(triple_buffer), 2);
+    EXPECT_FALSE(TripleBufferImpl::fetch(triple_buffer));
+    EXPECT_EQ(TripleBufferImpl::get_read_buffer(triple_buffer), 2);
+}
+
+//-----------------------------------------------------------------------------
+TEST(triple_buffer_test, test_no_torn_reads)
+{
+    constexpr u64 NUM_PUBLISHES = 200000;
+
+    TripleBuffer<Snapshot> triple_buffer;
+    std::atomic<bool> is_done{false};
+
+    std::thread writer([&]() {
+        for (mut_u64 i = 1; i <= NUM_PUBLISHES; ++i)
+        {
+            auto& snapshot = TripleBufferImpl::get_write_buffer(triple_buffer);
+            snapshot.values.fill(i);
+            TripleBufferImpl::publish(triple_buffer);
+        }
+        is_done = true;
+    });
+
+    mut_u64 last_value = 0;
+    bool is_last_fetch = false;
+    while (!is_last_fetch)
+    {
+        is_last_fetch = is_done;
+        if (!TripleBufferImpl::fetch(triple_buffer))
+            continue;
+
+        auto const& snapshot = TripleBufferImpl::get_read_buffer(triple_buffer);
+        for (auto value : snapshot.values)
+            ASSERT_EQ(value, snapshot.values.front());
+
+        ASSERT_GT(snapshot.values.front(), last_value);
+        last_value = snapshot.values.front();
+    }
+
+    writer.join();
+    EXPECT_EQ(last_value, NUM_PUBLISHES);
+}
+
+//-----------------------------------------------------------------------------
+} // namespace